@@ -0,0 +1,79 @@
+// Times rasterizing a recorded frame serially against rasterizing it in bands on the job system,
+// for increasing numbers of workers.
+// Usage: banded_rendering_bench [num_sprites]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "global_defs.h"
+#include "olcPixelGameEngine.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/sprite_spans.h"
+#include "utils/job_system.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kNumRepeats = 50;
+
+// Runs fn kNumRepeats times, returns the best time in microseconds.
+template <typename Fn>
+double Measure(Fn fn) {
+  double best_us = 1e30;
+  for (int repeat = 0; repeat < kNumRepeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    best_us = std::min(best_us, std::chrono::duration<double, std::micro>(elapsed).count());
+  }
+  return best_us;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int num_sprites = argc > 1 ? std::atoi(argv[1]) : 300;
+
+  // A translucent background over a fill, then the sprites, like a frame of the game.
+  olc::Sprite background{kScreenWidthPx, kScreenHeightPx};
+  for (int y = 0; y < background.height; ++y) {
+    for (int x = 0; x < background.width; ++x) {
+      background.SetPixel(x, y, olc::Pixel(x & 255, y & 255, 90, y < 120 ? 160 : 255));
+    }
+  }
+  olc::Sprite frame{80, 64};
+  for (int y = 0; y < frame.height; ++y) {
+    for (int x = 0; x < frame.width; ++x) {
+      const bool inside = x > 28 && x < 52 && y > 8;
+      frame.SetPixel(x, y, olc::Pixel(200, 100, 50, inside ? 255 : (x + y) % 3 == 0 ? 128 : 0));
+    }
+  }
+  const SpriteSpans background_spans{background};
+  const SpriteSpans frame_spans{frame};
+
+  DrawCommandList commands;
+  commands.Fill(olc::Pixel(30, 60, 90));
+  commands.DrawSpans(background.GetData(), background_spans, 0, 0, olc::Sprite::Flip::NONE);
+  for (int i = 0; i < num_sprites; ++i) {
+    commands.DrawSpans(frame.GetData(), frame_spans, (i * 37) % kScreenWidthPx - 40,
+                       (i * 11) % kScreenHeightPx - 32, olc::Sprite::Flip::HORIZ);
+  }
+
+  olc::Sprite target{kScreenWidthPx, kScreenHeightPx};
+  std::printf("%dx%d frame, %d sprites of 80x64\n", kScreenWidthPx, kScreenHeightPx, num_sprites);
+  const double serial_us = Measure([&] { commands.Replay(target); });
+  std::printf("  serial               %8.1f us/frame\n", serial_us);
+  const int max_workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  for (int num_workers = 0; num_workers <= max_workers; ++num_workers) {
+    JobSystem job_system{num_workers};
+    const int num_bands = 2 * job_system.GetConcurrency();
+    const double banded_us =
+        Measure([&] { commands.ReplayBanded(target, num_bands, job_system); });
+    std::printf("  %d threads, %2d bands  %8.1f us/frame (x%.2f)\n", job_system.GetConcurrency(),
+                num_bands, banded_us, serial_us / banded_us);
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Times the blit kernels of each instruction set against the engine's per pixel Draw.
+// Usage: blitter_bench
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/blitter.h"
+#include "rendering/sprite_spans.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 360;
+constexpr int kNumRepeats = 20;
+
+// Runs fn kNumRepeats times, prints the best time per pixel.
+template <typename Fn>
+void Measure(const char* name, const int num_pixels, Fn fn) {
+  double best_ns = 1e30;
+  for (int repeat = 0; repeat < kNumRepeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    best_ns = std::min(best_ns, std::chrono::duration<double, std::nano>(elapsed).count());
+  }
+  std::printf("  %-26s %7.3f ns/pixel\n", name, best_ns / num_pixels);
+}
+
+}  // namespace
+
+int main() {
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<int> byte{0, 255};
+  olc::Sprite source{kWidth, kHeight};
+  olc::Sprite target{kWidth, kHeight};
+  for (int i = 0; i < kWidth * kHeight; ++i) {
+    source.GetData()[i] = olc::Pixel(byte(rng), byte(rng), byte(rng), byte(rng));
+    target.GetData()[i] = olc::Pixel(byte(rng), byte(rng), byte(rng));
+  }
+
+  // An 80x64 frame that is mostly transparent margin, like the player sprites.
+  olc::Sprite frame{80, 64};
+  for (int y = 0; y < frame.height; ++y) {
+    for (int x = 0; x < frame.width; ++x) {
+      const bool inside = x > 28 && x < 52 && y > 8;
+      frame.SetPixel(x, y, olc::Pixel(200, 100, 50, inside ? 255 : 0));
+    }
+  }
+  const SpriteSpans frame_spans{frame};
+  constexpr int kNumFrames = 200;
+
+  olc::PixelGameEngine engine;
+  engine.SetDrawTarget(&target);
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  std::printf("engine\n");
+  Measure("blend (DrawSprite)", kWidth * kHeight, [&] { engine.DrawSprite(0, 0, &source); });
+  Measure("flipped blend", kWidth * kHeight,
+          [&] { engine.DrawSprite(0, 0, &source, 1, olc::Sprite::Flip::HORIZ); });
+  Measure("80x64 sprite frames", kNumFrames * 80 * 64, [&] {
+    for (int i = 0; i < kNumFrames; ++i) {
+      engine.DrawSprite((i * 37) % kWidth, (i * 11) % kHeight, &frame, 1, olc::Sprite::HORIZ);
+    }
+  });
+
+  const std::pair<const char*, BlitInstructionSet> instruction_sets[]{
+      {"scalar", BlitInstructionSet::kScalar},
+      {"sse2", BlitInstructionSet::kSse2},
+      {"avx2", BlitInstructionSet::kAvx2}};
+  for (const auto& [name, instruction_set] : instruction_sets) {
+    const auto* kernels = GetBlitKernels(instruction_set);
+    if (kernels == nullptr) {
+      std::printf("%s: not supported\n", name);
+      continue;
+    }
+    std::printf("%s\n", name);
+    const auto for_each_row = [&](auto kernel) {
+      for (int y = 0; y < kHeight; ++y) {
+        kernel(source.GetData() + y * kWidth, target.GetData() + y * kWidth, kWidth);
+      }
+    };
+    Measure("copy", kWidth * kHeight, [&] { for_each_row(kernels->copy); });
+    Measure("copy_reversed", kWidth * kHeight, [&] { for_each_row(kernels->copy_reversed); });
+    Measure("blend", kWidth * kHeight, [&] { for_each_row(kernels->blend); });
+    Measure("blend_reversed", kWidth * kHeight, [&] { for_each_row(kernels->blend_reversed); });
+    Measure("80x64 sprite frames", kNumFrames * 80 * 64, [&] {
+      for (int i = 0; i < kNumFrames; ++i) {
+        DrawSpans(frame, frame_spans, (i * 37) % kWidth, (i * 11) % kHeight,
+                  olc::Sprite::Flip::HORIZ, target, *kernels);
+      }
+    });
+  }
+  return 0;
+}
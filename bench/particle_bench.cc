@@ -0,0 +1,132 @@
+// Times a frame of the particle system with many live particles: moving them, copying them into
+// the snapshot and drawing them, against the 10 ms frame budget.
+// Usage: particle_bench [num_particles] [num_workers]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "animation/sprite_manager.h"
+#include "common_types/game_configuration.h"
+#include "global_defs.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "systems/particle_system.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+#include "utils/random_number_generator.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kNumFrames = 120;
+constexpr double kFrameDeltaT = 1. / 60.;
+constexpr double kFrameBudgetMs = 10.;
+
+// A closed room a little larger than the screen, with rows of thin platforms.
+Level MakeLevel() {
+  constexpr int kWidth = 48;
+  constexpr int kHeight = 28;
+  Level level{};
+  level.level_tileset = std::make_shared<TileSet>("bench", 0, 1, 1, 16);
+  level.tile_grid = Grid<Tile>(kWidth, kHeight);
+  level.property_grid = Grid<int>(kWidth, kHeight);
+  for (int x = 0; x < kWidth; ++x) {
+    level.property_grid.SetTile(x, 0, kSolidProperty);
+    level.property_grid.SetTile(x, kHeight - 1, kSolidProperty);
+  }
+  for (int y = 0; y < kHeight; ++y) {
+    level.property_grid.SetTile(0, y, kSolidProperty);
+    level.property_grid.SetTile(kWidth - 1, y, kSolidProperty);
+  }
+  for (int y = 5; y < kHeight - 1; y += 5) {
+    for (int x = 3 + y % 4; x < kWidth - 3; x += 6) {
+      level.property_grid.SetTile(x, y, kSolidProperty);
+      level.property_grid.SetTile(x + 1, y, kSolidProperty);
+    }
+  }
+  return level;
+}
+
+double ElapsedMs(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int num_particles = argc > 1 ? std::atoi(argv[1]) : 100000;
+  const int num_workers =
+      argc > 2 ? std::atoi(argv[2])
+               : std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+  const auto level = MakeLevel();
+  auto parameter_server = std::make_shared<ParameterServer>();
+  auto job_system = std::make_shared<JobSystem>(num_workers);
+  auto registry = std::make_shared<Registry>();
+  parameter_server->AddParameter("physics/gravity", 30., "");
+  ParticleSystem particles{level, parameter_server, std::make_shared<RandomNumberGenerator>(),
+                           job_system};
+  parameter_server->SetParameter<double>("particles/max.count", num_particles);
+
+  olc::PixelGameEngine engine;
+  RenderingSystem rendering_system{&engine,
+                                   level,
+                                   parameter_server,
+                                   std::make_shared<SpriteManager>(registry),
+                                   registry,
+                                   job_system};
+  olc::Sprite framebuffer{kScreenWidthPx, kScreenHeightPx};
+  rendering_system.SetRenderTarget(&framebuffer);
+  rendering_system.SetCameraPosition({1, 1});
+
+  // Spread over the room, flying in every direction. They outlive the benchmark.
+  std::mt19937 rng{5};
+  std::uniform_real_distribution<double> x{1., 47.};
+  std::uniform_real_distribution<double> y{1., 27.};
+  std::uniform_real_distribution<double> velocity{-8., 8.};
+  for (int i = 0; i < num_particles; ++i) {
+    particles.Emit({x(rng), y(rng)}, {velocity(rng), velocity(rng)}, olc::WHITE, 1e3);
+  }
+
+  double update_ms = 0.;
+  double capture_ms = 0.;
+  double render_ms = 0.;
+  double worst_frame_ms = 0.;
+  RenderSnapshot snapshot;
+  // Warm up, the first frame allocates the snapshot and the render queue.
+  particles.Update(kFrameDeltaT);
+  particles.Capture(snapshot.particles);
+  rendering_system.RenderEntities(snapshot);
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const auto frame_start = std::chrono::steady_clock::now();
+    particles.Update(kFrameDeltaT);
+    const double update_end_ms = ElapsedMs(frame_start);
+    particles.Capture(snapshot.particles);
+    const double capture_end_ms = ElapsedMs(frame_start);
+    rendering_system.RenderEntities(snapshot);
+    const double frame_ms = ElapsedMs(frame_start);
+
+    update_ms += update_end_ms;
+    capture_ms += capture_end_ms - update_end_ms;
+    render_ms += frame_ms - capture_end_ms;
+    worst_frame_ms = std::max(worst_frame_ms, frame_ms);
+  }
+
+  std::printf("%d particles, %d threads, %d frames\n", particles.GetNumParticles(),
+              job_system->GetConcurrency(), kNumFrames);
+  std::printf("  update   %6.2f ms/frame\n", update_ms / kNumFrames);
+  std::printf("  capture  %6.2f ms/frame\n", capture_ms / kNumFrames);
+  std::printf("  render   %6.2f ms/frame\n", render_ms / kNumFrames);
+  const double mean_frame_ms = (update_ms + capture_ms + render_ms) / kNumFrames;
+  std::printf("  total    %6.2f ms/frame (worst %.2f ms), budget %.0f ms: %s\n", mean_frame_ms,
+              worst_frame_ms, kFrameBudgetMs, mean_frame_ms <= kFrameBudgetMs ? "ok" : "OVER");
+  return 0;
+}
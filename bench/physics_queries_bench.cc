@@ -0,0 +1,140 @@
+// Times the PhysicsSystem query API on a synthetic level.
+// Usage: physics_queries_bench [num_workers]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "registry.h"
+#include "systems/physics_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kWidth = 256;
+constexpr int kHeight = 64;
+constexpr int kNumActors = 2000;
+constexpr int kNumQueries = 100000;
+constexpr int kNumRepeats = 5;
+
+// A closed room with platforms scattered over it.
+Level MakeLevel() {
+  Level level{};
+  level.property_grid = Grid<int>(kWidth, kHeight);
+  for (int x = 0; x < kWidth; ++x) {
+    level.property_grid.SetTile(x, 0, kSolidProperty);
+    level.property_grid.SetTile(x, kHeight - 1, kSolidProperty);
+  }
+  for (int y = 0; y < kHeight; ++y) {
+    level.property_grid.SetTile(0, y, kSolidProperty);
+    level.property_grid.SetTile(kWidth - 1, y, kSolidProperty);
+  }
+  for (int x = 4; x < kWidth - 4; x += 3) {
+    level.property_grid.SetTile(x, 4 + (x * 7) % (kHeight - 8), kSolidProperty);
+  }
+  level.level_tileset = std::make_shared<TileSet>("bench", 0, 1, 1, 16);
+  return level;
+}
+
+Vector2d PointAt(const int i) {
+  return {1.5 + (i * 37) % (kWidth - 3) + (i % 10) / 10., 1.5 + (i * 17) % (kHeight - 3)};
+}
+
+// Runs fn kNumRepeats times, prints the best time per query.
+template <typename Fn>
+void Measure(const std::string& name, Fn fn) {
+  double best_ns = 1e30;
+  int checksum = 0;
+  for (int repeat = 0; repeat < kNumRepeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    checksum = fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    best_ns = std::min(best_ns, std::chrono::duration<double, std::nano>(elapsed).count());
+  }
+  std::printf("%-28s %8.1f ns/query  (checksum %d)\n", name.c_str(), best_ns / kNumQueries,
+              checksum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int num_workers = argc > 1 ? std::atoi(argv[1]) : 0;
+  const auto level = MakeLevel();
+  auto registry = std::make_shared<Registry>();
+  PhysicsSystem physics{level, std::make_shared<ParameterServer>(),
+                        std::make_shared<JobSystem>(num_workers), registry};
+  // Actors are half a tile wide and one tile high, and never placed inside a solid tile.
+  for (int i = 0, num_actors = 0; num_actors < kNumActors; ++i) {
+    const auto point = PointAt(i * 3);
+    if (physics.IsAreaFree(BoundingBox{point.x, point.x + 0.5, point.y, point.y + 1})) {
+      registry->AddComponents(Position{point.x, point.y}, Velocity{}, CollisionBox{0, 0, 8, 16},
+                              Collision{});
+      ++num_actors;
+    }
+  }
+  physics.PhysicsStep(0.);
+
+  std::vector<Ray> rays;
+  for (int i = 0; i < kNumQueries; ++i) {
+    const auto start = PointAt(i);
+    rays.push_back(Ray{start, Vector2d{start.x + (i % 41) - 20., start.y + (i % 23) - 11.}});
+  }
+
+  std::printf("%d actors, %d queries, %d workers\n", kNumActors, kNumQueries, num_workers);
+  Measure("Raycast", [&] {
+    int num_hits = 0;
+    for (const auto& ray : rays) {
+      num_hits += physics.Raycast(ray).has_value();
+    }
+    return num_hits;
+  });
+  Measure("Raycast (tiles only)", [&] {
+    int num_hits = 0;
+    for (const auto& ray : rays) {
+      num_hits += physics.Raycast(Ray{ray.start, ray.end, 0, true, false}).has_value();
+    }
+    return num_hits;
+  });
+  Measure("RaycastBatch", [&] {
+    int num_hits = 0;
+    for (const auto& hit : physics.RaycastBatch(rays)) {
+      num_hits += hit.has_value();
+    }
+    return num_hits;
+  });
+  Measure("QueryAabb (2x2 tiles)", [&] {
+    int num_found = 0;
+    for (int i = 0; i < kNumQueries; ++i) {
+      const auto point = PointAt(i);
+      num_found += static_cast<int>(
+          physics.QueryAabb(BoundingBox{point.x - 1, point.x + 1, point.y - 1, point.y + 1})
+              .size());
+    }
+    return num_found;
+  });
+  Measure("IsAreaFree (2x2 tiles)", [&] {
+    int num_free = 0;
+    for (int i = 0; i < kNumQueries; ++i) {
+      const auto point = PointAt(i);
+      num_free +=
+          physics.IsAreaFree(BoundingBox{point.x - 1, point.x + 1, point.y - 1, point.y + 1});
+    }
+    return num_free;
+  });
+  Measure("NearestEntity (r = 5)", [&] {
+    int num_found = 0;
+    for (int i = 0; i < kNumQueries; ++i) {
+      num_found += physics.NearestEntity(PointAt(i), 5.).has_value();
+    }
+    return num_found;
+  });
+  return 0;
+}
@@ -0,0 +1,135 @@
+// Times a frame of shotgun pellets through the renderer: RenderingSystem::RenderEntities on a
+// snapshot of pellets, which submits them as one batch, flushes the render queue and replays the
+// draw commands. For comparison, the same through a queue item per pellet, as pellets used to be
+// submitted, through a std::function per pellet and the engine, as they were drawn before the
+// render queue, and the bare DrawPrimitives the replay ends up in.
+// Usage: primitive_batch_bench [num_pellets]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "animation/sprite_manager.h"
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "global_defs.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/primitive_batch.h"
+#include "rendering/render_queue.h"
+#include "rendering/render_snapshot.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kNumRepeats = 50;
+constexpr int kTileSize = 16;
+
+// Runs fn kNumRepeats times, returns the best time in microseconds.
+template <typename Fn>
+double Measure(Fn fn) {
+  double best_us = 1e30;
+  for (int repeat = 0; repeat < kNumRepeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    best_us = std::min(best_us, std::chrono::duration<double, std::micro>(elapsed).count());
+  }
+  return best_us;
+}
+
+// An empty level larger than the screen, so the camera can sit at the origin.
+Level MakeLevel() {
+  Level level{};
+  level.level_tileset = std::make_shared<TileSet>("bench", 0, 1, 1, kTileSize);
+  level.tile_grid = Grid<Tile>(64, 32);
+  level.property_grid = Grid<int>(64, 32);
+  return level;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int num_pellets = argc > 1 ? std::atoi(argv[1]) : 5000;
+
+  // Spread over and a little beyond the screen, so some are clipped.
+  std::mt19937 rng{3};
+  std::uniform_int_distribution<int> x{-10, kScreenWidthPx + 10};
+  std::uniform_int_distribution<int> y{-10, kScreenHeightPx + 10};
+  RenderSnapshot snapshot;
+  std::vector<Primitive> pellets;
+  for (int i = 0; i < num_pellets; ++i) {
+    const Primitive pellet{x(rng), y(rng), olc::WHITE, PrimitiveShape::kPlus};
+    pellets.push_back(pellet);
+    // At the same pixel as the pellet, with the camera at the origin.
+    RenderEntity entity{};
+    entity.id = static_cast<EntityId>(i);
+    entity.position = Position{pellet.x / static_cast<double>(kTileSize),
+                               (kScreenHeightPx - pellet.y) / static_cast<double>(kTileSize)};
+    entity.primitive = PrimitiveComponent{Rgba{255, 255, 255}, PrimitiveShape::kPlus};
+    snapshot.entities.push_back(entity);
+  }
+
+  olc::Sprite target{kScreenWidthPx, kScreenHeightPx};
+  olc::PixelGameEngine engine;
+  engine.SetDrawTarget(&target);
+  auto registry = std::make_shared<Registry>();
+  RenderingSystem rendering_system{&engine,
+                                   MakeLevel(),
+                                   std::make_shared<ParameterServer>(),
+                                   std::make_shared<SpriteManager>(registry),
+                                   registry,
+                                   std::make_shared<JobSystem>(0)};
+  rendering_system.SetRenderTarget(&target);
+  rendering_system.SetCameraPosition({0, 0});
+
+  std::printf("%d pellets on a %dx%d frame\n", num_pellets, kScreenWidthPx, kScreenHeightPx);
+  const double render_us = Measure([&] { rendering_system.RenderEntities(snapshot); });
+  std::printf("  RenderEntities        %8.1f us/frame\n", render_us);
+
+  RenderQueue queue;
+  DrawCommandList commands;
+  const double queue_items_us = Measure([&] {
+    for (const auto& pellet : pellets) {
+      queue.SubmitPrimitive(RenderLayer::kEffects, 0, pellet.x, pellet.y, pellet.color,
+                            pellet.shape);
+    }
+    commands.Clear();
+    queue.Flush(commands);
+    commands.Replay(target);
+  });
+  std::printf("  queue item per pellet %8.1f us/frame (x%.1f)\n", queue_items_us,
+              queue_items_us / render_us);
+
+  const std::function<void(int, int, olc::PixelGameEngine*)> draw_fn =
+      [](int px, int py, olc::PixelGameEngine* engine_ptr) {
+        engine_ptr->Draw(px, py, olc::WHITE);
+        engine_ptr->Draw(px + 1, py, olc::WHITE);
+        engine_ptr->Draw(px, py + 1, olc::WHITE);
+        engine_ptr->Draw(px - 1, py, olc::WHITE);
+        engine_ptr->Draw(px, py - 1, olc::WHITE);
+      };
+  const double function_us = Measure([&] {
+    for (const auto& pellet : pellets) {
+      draw_fn(pellet.x, pellet.y, &engine);
+    }
+  });
+  std::printf("  draw functions        %8.1f us/frame (x%.1f)\n", function_us,
+              function_us / render_us);
+
+  const double batch_us = Measure([&] {
+    DrawPrimitives(pellets.data(), num_pellets, target, RowRange{0, kScreenHeightPx});
+  });
+  std::printf("  DrawPrimitives only   %8.1f us/frame\n", batch_us);
+  return 0;
+}
@@ -0,0 +1,135 @@
+// Times RenderTiles, which draws pre-rendered tile chunks, against drawing every visible tile with
+// the engine, as RenderTiles did before the chunk cache.
+// Pans the camera across the first level of levels.json.
+// Usage: tile_rendering_bench [num_frames]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+
+#include "animation/sprite_manager.h"
+#include "common_types/basic_types.h"
+#include "common_types/game_configuration.h"
+#include "config.h"
+#include "global_defs.h"
+#include "load_game_configuration.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kNumRepeats = 5;
+
+uint64_t HashPixels(const olc::Sprite& sprite) {
+  uint64_t hash = 1469598103934665603ull;
+  for (const auto& pixel : sprite.pColData) {
+    hash = (hash ^ pixel.n) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// The per tile path: one DrawSprite per visible tile, for a camera at the given position in tiles.
+void DrawTilesPerTile(olc::PixelGameEngine& engine, const Level& level, const Vector2d& position) {
+  const auto& tilemap = level.tile_grid;
+  const auto& tileset = *level.level_tileset;
+  const int tile_size = tileset.GetTileSize();
+  const double viewport_width = kScreenWidthPx / static_cast<double>(tile_size);
+  const double viewport_height = kScreenHeightPx / static_cast<double>(tile_size);
+  for (int y_itr = 0; y_itr <= viewport_height + 1; ++y_itr) {
+    for (int x_itr = 0; x_itr <= viewport_width + 1; ++x_itr) {
+      const double lookup_x = position.x + x_itr;
+      const double lookup_y = position.y + y_itr;
+      const int lookup_x_int = static_cast<int>(std::floor(lookup_x));
+      const int lookup_y_int = static_cast<int>(std::floor(lookup_y));
+      if (lookup_x_int < 0 || lookup_x_int >= tilemap.GetWidth() || lookup_y_int < 0 ||
+          lookup_y_int >= tilemap.GetHeight()) {
+        continue;
+      }
+      const int tile_idx = tilemap.GetTile(lookup_x_int, lookup_y_int).tile_id;
+      if (tile_idx == 0) {
+        continue;
+      }
+
+      const double x_fraction = lookup_x - lookup_x_int;
+      const double y_fraction = lookup_y - lookup_y_int;
+      const int x_px = static_cast<int>(std::round((x_itr - x_fraction) * tile_size));
+      const int y_px =
+          static_cast<int>(std::round(kScreenHeightPx - (y_itr + 1 - y_fraction) * tile_size));
+      engine.DrawSprite(x_px, y_px, tileset.GetTile(tile_idx));
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int num_frames = argc > 1 ? std::atoi(argv[1]) : 600;
+  const auto levels_path = std::filesystem::path(SOURCE_DIR) / "levels.json";
+  const auto config = LoadGameConfiguration(levels_path.string());
+  if (!config.has_value() || config->levels.empty()) {
+    std::fprintf(stderr, "Could not load %s\n", levels_path.string().c_str());
+    return 1;
+  }
+
+  olc::PixelGameEngine engine;
+  olc::Sprite screen{kScreenWidthPx, kScreenHeightPx};
+  engine.SetDrawTarget(&screen);
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  auto registry = std::make_shared<Registry>();
+  RenderingSystem rendering_system{&engine, config->levels.front(),
+                                   std::make_shared<ParameterServer>(),
+                                   std::make_shared<SpriteManager>(registry), registry,
+                                   std::make_shared<JobSystem>(0)};
+
+  // Pans right and up one pixel per frame and a bit, wrapping at the level bounds.
+  const auto& level = config->levels.front();
+  const int tile_size = level.level_tileset->GetTileSize();
+  const int max_x = level.tile_grid.GetWidth() * tile_size - kScreenWidthPx;
+  const int max_y = level.tile_grid.GetHeight() * tile_size - kScreenHeightPx;
+  const auto run = [&](const bool per_tile) {
+    uint64_t hash = 0;
+    for (int frame = 0; frame < num_frames; ++frame) {
+      const int x = max_x > 0 ? (frame * 3) % max_x : 0;
+      const int y = max_y > 0 ? frame % max_y : 0;
+      const Vector2d position{x / static_cast<double>(tile_size),
+                              y / static_cast<double>(tile_size)};
+      engine.Clear(olc::Pixel(30, 60, 90));
+      if (per_tile) {
+        DrawTilesPerTile(engine, level, position);
+      } else {
+        rendering_system.SetCameraPosition(position);
+        rendering_system.RenderTiles();
+      }
+      if (frame % 16 == 0) {
+        hash ^= HashPixels(screen) + frame;
+      }
+    }
+    return hash;
+  };
+
+  std::printf("%d frames of %dx%d, tile size %d\n", num_frames, kScreenWidthPx, kScreenHeightPx,
+              tile_size);
+  uint64_t hashes[2]{};
+  for (const bool per_tile : {true, false}) {
+    double best_s = 1e30;
+    for (int repeat = 0; repeat < kNumRepeats; ++repeat) {
+      const auto start = std::chrono::steady_clock::now();
+      hashes[per_tile] = run(per_tile);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      best_s = std::min(best_s, elapsed.count());
+    }
+    std::printf("%-14s %8.1f us/frame\n", per_tile ? "Per tile" : "Tile chunks",
+                best_s * 1e6 / num_frames);
+  }
+  // Every 16th frame is compared, the hashing is included in both timings.
+  std::printf("Frames %s\n", hashes[0] == hashes[1] ? "match" : "DIFFER");
+  return hashes[0] == hashes[1] ? 0 : 1;
+}
@@ -45,6 +45,9 @@ void AnimatedSprite::InitializeOtherState(AnimatedSprite& animated_sprite) {
       animated_sprite.frame_timing_.push_back(animated_sprite.frame_timing_[frame_idx]);
     }
   }
+  for (const auto& frame : animated_sprite.frames_) {
+    animated_sprite.frame_spans_.emplace_back(*frame);
+  }
   animated_sprite.frame_timing_lookup_.push_back(animated_sprite.frame_timing_[0]);
 
   for (int i = 1; i < animated_sprite.frame_timing_.size(); ++i) {
@@ -186,13 +189,23 @@ std::optional<AnimatedSprite> AnimatedSprite::CreateAnimatedSprite(
 Sprite AnimatedSprite::GetFrame(const TimePoint start_time) const {
   const auto current_frame_idx = GetCurrentFrameIdx(start_time);
   if (current_frame_idx.Expired()) {
-    return {frames_.back().get(), draw_offset_x, draw_offset_y};
+    return {frames_.back().get(), draw_offset_x, draw_offset_y, &frame_spans_.back()};
   }
-  return {frames_.at(current_frame_idx.Index()).get(), draw_offset_x, draw_offset_y};
+  const auto index = current_frame_idx.Index();
+  return {frames_.at(index).get(), draw_offset_x, draw_offset_y, &frame_spans_.at(index)};
 }
 
 int AnimatedSprite::GetTotalAnimationTimeMs() const { return frame_timing_lookup_.back(); }
 
+SpriteExtent AnimatedSprite::GetMaxExtent() const {
+  SpriteExtent extent{};
+  for (const auto& frame : frames_) {
+    extent = Union(extent,
+                   GetSpriteExtent(frame->width, frame->height, draw_offset_x, draw_offset_y));
+  }
+  return extent;
+}
+
 AnimationFrameIndex AnimatedSprite::GetCurrentFrameIdx(const TimePoint start_time) const {
   auto time_elapsed = ToMs(GameClock::NowGlobal() - start_time);
 
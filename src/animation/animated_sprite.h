@@ -9,6 +9,7 @@
 
 #include "animation/animation_frame_index.h"
 #include "common_types/sprite.h"
+#include "rendering/sprite_spans.h"
 #include "utils/chrono_helpers.h"
 
 namespace platformer {
@@ -69,6 +70,9 @@ class AnimatedSprite {
 
   [[nodiscard]] int GetTotalAnimationTimeMs() const;
 
+  // Covers every frame.
+  [[nodiscard]] SpriteExtent GetMaxExtent() const;
+
  private:
   AnimatedSprite() = default;
 
@@ -80,6 +84,7 @@ class AnimatedSprite {
   int draw_offset_x;
   int draw_offset_y;
   std::vector<std::unique_ptr<olc::Sprite>> frames_;
+  std::vector<SpriteSpans> frame_spans_;
   std::vector<int> frame_timing_;
   std::vector<int> frame_timing_lookup_;
 
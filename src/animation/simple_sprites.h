@@ -5,7 +5,6 @@
 
 namespace platformer {
 
-std::unique_ptr<olc::Sprite> CreateShotgunPelletSprite();
 AnimatedSprite CreateSmallWallHitEffectSprite();
 
 }  // namespace platformer
\ No newline at end of file
@@ -11,6 +11,7 @@
 namespace platformer {
 
 void SpriteManager::AddAnimation(const std::string& key, AnimatedSprite sprite) {
+  max_sprite_extent_ = Union(max_sprite_extent_, sprite.GetMaxExtent());
   animated_sprites_.try_emplace(key, std::move(sprite));
 }
 
@@ -18,13 +19,16 @@ void SpriteManager::AddSprite(const std::string& key,
                               const int draw_offset_x,
                               const int draw_offset_y,
                               std::unique_ptr<olc::Sprite> sprite) {
-  SpriteStorage s{std::move(sprite), draw_offset_x, draw_offset_y};
+  max_sprite_extent_ = Union(max_sprite_extent_, GetSpriteExtent(sprite->width, sprite->height,
+                                                                draw_offset_x, draw_offset_y));
+  SpriteSpans spans{*sprite};
+  SpriteStorage s{std::move(sprite), draw_offset_x, draw_offset_y, std::move(spans)};
   sprites_.try_emplace(key, std::move(s));
 }
 
 Sprite SpriteManager::GetSprite(const std::string& key) const {
   const auto& sprite = sprites_.at(key);
-  return {sprite.sprite.get(), sprite.draw_offset_x, sprite.draw_offset_y};
+  return {sprite.sprite.get(), sprite.draw_offset_x, sprite.draw_offset_y, &sprite.spans};
 }
 
 AnimatedSprite& SpriteManager::GetAnimation(const std::string& key) {
@@ -9,6 +9,7 @@
 #include "common_types/entity.h"
 #include "registry.h"
 #include "registry_helpers.h"
+#include "rendering/sprite_spans.h"
 
 namespace platformer {
 
@@ -39,16 +40,22 @@ class SpriteManager {
 
   [[nodiscard]] Sprite GetSprite(EntityId id) const;
 
+  // Covers every sprite and animation frame added so far. Lets callers bound what an entity
+  // draws without looking its sprite up.
+  [[nodiscard]] SpriteExtent GetMaxSpriteExtent() const { return max_sprite_extent_; }
+
  private:
   struct SpriteStorage {
     std::unique_ptr<olc::Sprite> sprite;
     int draw_offset_x;
     int draw_offset_y;
+    SpriteSpans spans;
   };
 
   std::map<std::string, AnimatedSprite> animated_sprites_;
   std::map<std::string, InsideSpriteLocation> inside_sprite_locations_;
   std::map<std::string, SpriteStorage> sprites_;
   std::shared_ptr<Registry> registry_;
+  SpriteExtent max_sprite_extent_{};
 };
 }  // namespace platformer
\ No newline at end of file
@@ -31,6 +31,8 @@ struct BoundingBox {
 
 enum class Direction : uint8_t { LEFT, RIGHT, UP, DOWN };
 
+enum class Axis : uint8_t { X, Y };
+
 inline std::string ToString(Direction direction) {
   switch (direction) {
     case Direction::LEFT:
@@ -0,0 +1,76 @@
+#include "bit_grid.h"
+
+#include <algorithm>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+// Bits [first, last] of a word set, with 0 <= first <= last < 64.
+uint64_t SpanMask(const int first, const int last) {
+  const uint64_t upper = last == 63 ? ~uint64_t{0} : (uint64_t{1} << (last + 1)) - 1;
+  return upper & ~((uint64_t{1} << first) - 1);
+}
+
+}  // namespace
+
+BitGrid::BitGrid(const int width, const int height)
+    : width_{width},
+      height_{height},
+      words_per_row_{(width + kWordBits - 1) / kWordBits},
+      words_(static_cast<size_t>(words_per_row_) * height) {
+  RB_CHECK(width > 0 && height > 0);
+}
+
+void BitGrid::Set(const int x, const int y, const bool value) {
+  RB_CHECK(x >= 0 && y >= 0 && x < width_ && y < height_);
+  uint64_t& word = words_[y * words_per_row_ + x / kWordBits];
+  const uint64_t bit = uint64_t{1} << (x % kWordBits);
+  word = value ? word | bit : word & ~bit;
+}
+
+bool BitGrid::AnyInRow(const int y, int min_x, int max_x) const {
+  if (y < 0 || y >= height_) {
+    return false;
+  }
+  min_x = std::max(min_x, 0);
+  max_x = std::min(max_x, width_ - 1);
+  if (min_x > max_x) {
+    return false;
+  }
+  const uint64_t* row = GetRow(y);
+  const int first_word = min_x / kWordBits;
+  const int last_word = max_x / kWordBits;
+  if (first_word == last_word) {
+    return (row[first_word] & SpanMask(min_x % kWordBits, max_x % kWordBits)) != 0;
+  }
+  if ((row[first_word] & SpanMask(min_x % kWordBits, kWordBits - 1)) != 0) {
+    return true;
+  }
+  for (int word = first_word + 1; word < last_word; ++word) {
+    if (row[word] != 0) {
+      return true;
+    }
+  }
+  return (row[last_word] & SpanMask(0, max_x % kWordBits)) != 0;
+}
+
+bool BitGrid::AnyInColumn(const int x, int min_y, int max_y) const {
+  if (x < 0 || x >= width_) {
+    return false;
+  }
+  min_y = std::max(min_y, 0);
+  max_y = std::min(max_y, height_ - 1);
+  const int word = x / kWordBits;
+  const uint64_t bit = uint64_t{1} << (x % kWordBits);
+  for (int y = min_y; y <= max_y; ++y) {
+    if ((GetRow(y)[word] & bit) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace platformer
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common_types/grid.h"
+
+namespace platformer {
+
+// One bit per tile, packed 64 tiles per word along each row.
+//
+// Coordinates outside of the grid read as unset, so callers can query spans that run off the
+// level without clamping them first.
+class BitGrid {
+ public:
+  BitGrid() = default;
+  BitGrid(int width, int height);
+
+  // Sets every tile of `grid` equal to `value`.
+  template <typename T>
+  static BitGrid FromGrid(const Grid<T>& grid, const T& value) {
+    BitGrid bit_grid{grid.GetWidth(), grid.GetHeight()};
+    for (int y = 0; y < grid.GetHeight(); ++y) {
+      for (int x = 0; x < grid.GetWidth(); ++x) {
+        bit_grid.Set(x, y, grid.GetTile(x, y) == value);
+      }
+    }
+    return bit_grid;
+  }
+
+  void Set(int x, int y, bool value);
+  [[nodiscard]] bool Get(const int x, const int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return false;
+    }
+    return (GetRow(y)[x / kWordBits] >> (x % kWordBits)) & 1;
+  }
+
+  // Whether any tile in the inclusive span is set. Rows are tested a word at a time.
+  [[nodiscard]] bool AnyInRow(int y, int min_x, int max_x) const;
+  [[nodiscard]] bool AnyInColumn(int x, int min_y, int max_y) const;
+
+  [[nodiscard]] int GetWidth() const { return width_; }
+  [[nodiscard]] int GetHeight() const { return height_; }
+
+ private:
+  static constexpr int kWordBits = 64;
+
+  [[nodiscard]] const uint64_t* GetRow(int y) const { return &words_[y * words_per_row_]; }
+
+  int width_{};
+  int height_{};
+  int words_per_row_{};
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace platformer
@@ -1,18 +1,15 @@
 #pragma once
 
-#include <functional>
+#include <cstdint>
 #include <limits>
 #include <set>
 
 #include "animation/animation_frame_index.h"
 #include "common_types/actor_state.h"
 #include "common_types/basic_types.h"
+#include "common_types/entity.h"
 #include "utils/game_clock.h"
 
-namespace olc {
-class PixelGameEngine;
-}
-
 namespace platformer {
 
 struct Position {
@@ -70,19 +67,34 @@ struct AnimatedSpriteComponent {
   std::string key{};
 };
 
-struct DrawFunction {
-  // Arguments are pixel coordinates of the entity's position and an olc engine ptr
-  // (Entity must also have a Position Component)
-  std::function<void(int, int, olc::PixelGameEngine*)> draw_fn;
+enum class PrimitiveShape : uint8_t {
+  kPoint,
+  kPlus,  // The point and its four neighbours.
+};
+
+// 8 bits per channel, so components do not need the engine's olc::Pixel.
+struct Rgba {
+  uint8_t r{255};
+  uint8_t g{255};
+  uint8_t b{255};
+  uint8_t a{255};
+};
+
+// A small opaque shape drawn at the pixel of the entity's position, e.g. a shotgun pellet.
+// (Entity must also have a Position Component)
+struct PrimitiveComponent {
+  Rgba color{};
+  PrimitiveShape shape{PrimitiveShape::kPoint};
 };
 
 struct DistanceFallen {
   double distance_fallen{};
 };
 
-struct Projectile {};
-
-struct Particle {};
+struct Projectile {
+  int num_bounces{};      // Off the level.
+  EntityId shooter_id{};  // Never hit by its own shots. Zero if nobody fired it.
+};
 
 struct TimeToDespawn {
   TimeToDespawn() = default;
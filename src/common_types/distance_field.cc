@@ -0,0 +1,93 @@
+#include "distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common_types/ray_casting.h"
+
+namespace platformer {
+
+DistanceField::DistanceField(const BitGrid& solid_tiles)
+    : width_{solid_tiles.GetWidth()},
+      height_{solid_tiles.GetHeight()},
+      distances_(static_cast<size_t>(width_) * height_) {
+  // Two pass chamfer transform. With unit weights for all 8 neighbours it gives the exact
+  // Chebyshev distance.
+  std::vector<int> distances(distances_.size());
+  const auto at = [&](const int x, const int y) -> int& { return distances[y * width_ + x]; };
+  constexpr int kInfinity = 1 << 20;
+  for (int y = 0; y < height_; ++y) {
+    for (int x = 0; x < width_; ++x) {
+      at(x, y) = solid_tiles.Get(x, y) ? 0 : kInfinity;
+    }
+  }
+  const auto relax = [&](const int x, const int y, const int neighbour_x,
+                         const int neighbour_y) {
+    if (neighbour_x >= 0 && neighbour_x < width_ && neighbour_y >= 0 && neighbour_y < height_) {
+      at(x, y) = std::min(at(x, y), at(neighbour_x, neighbour_y) + 1);
+    }
+  };
+  for (int y = 0; y < height_; ++y) {
+    for (int x = 0; x < width_; ++x) {
+      relax(x, y, x - 1, y);
+      relax(x, y, x - 1, y - 1);
+      relax(x, y, x, y - 1);
+      relax(x, y, x + 1, y - 1);
+    }
+  }
+  for (int y = height_ - 1; y >= 0; --y) {
+    for (int x = width_ - 1; x >= 0; --x) {
+      relax(x, y, x + 1, y);
+      relax(x, y, x + 1, y + 1);
+      relax(x, y, x, y + 1);
+      relax(x, y, x - 1, y + 1);
+    }
+  }
+  std::transform(distances.begin(), distances.end(), distances_.begin(),
+                 [](const int distance) { return std::min(distance, kMaxDistance); });
+}
+
+int DistanceField::GetDistance(const int x, const int y) const {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return 0;
+  }
+  return distances_[y * width_ + x];
+}
+
+bool DistanceField::IsSolid(const int x, const int y) const {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return false;
+  }
+  return distances_[y * width_ + x] == 0;
+}
+
+double DistanceField::GetFreeDistance(const double x, const double y) const {
+  const int distance =
+      GetDistance(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)));
+  return std::max(distance - 1, 0);
+}
+
+bool DistanceField::HasLineOfSight(const Vector2d& from, const Vector2d& to) const {
+  const auto is_solid = [this](const int x, const int y) { return IsSolid(x, y); };
+  if (IsSolid(static_cast<int>(std::floor(from.x)), static_cast<int>(std::floor(from.y)))) {
+    return false;
+  }
+  Vector2d start = from;
+  while (true) {
+    const Vector2d delta = to - start;
+    const double length = std::max(std::abs(delta.x), std::abs(delta.y));
+    const double free_distance = GetFreeDistance(start.x, start.y);
+    if (length < free_distance) {
+      return true;
+    }
+    if (free_distance < 1.) {
+      // Close to geometry, walk the remaining tiles.
+      return !FindFirstSolidCrossing(start, delta, is_solid).has_value();
+    }
+    // Stay strictly inside the free region.
+    const double fraction = (free_distance - 0.5) / length;
+    start = Vector2d{start.x + delta.x * fraction, start.y + delta.y * fraction};
+  }
+}
+
+}  // namespace platformer
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common_types/basic_types.h"
+#include "common_types/bit_grid.h"
+
+namespace platformer {
+
+// Per tile Chebyshev distance, in tiles, to the nearest solid tile. Built once per level.
+//
+// A point in a tile at distance d can move up to d - 1 tiles along each axis without entering a
+// solid tile, so movers in open space can skip the per tile collision tests.
+class DistanceField {
+ public:
+  // Distances saturate at this value, it then is a lower bound.
+  static constexpr int kMaxDistance = 255;
+
+  DistanceField() = default;
+  explicit DistanceField(const BitGrid& solid_tiles);
+
+  // Zero for solid tiles and, since the field knows nothing about them, for tiles outside the
+  // level.
+  [[nodiscard]] int GetDistance(int x, int y) const;
+  [[nodiscard]] bool IsSolid(int x, int y) const;
+
+  // A segment starting at (x, y) that is shorter than this along both axes does not enter a
+  // solid tile.
+  [[nodiscard]] double GetFreeDistance(double x, double y) const;
+
+  // Whether the segment between the points passes through no solid tile. Skips through open
+  // space using the field and only walks tile by tile near geometry.
+  [[nodiscard]] bool HasLineOfSight(const Vector2d& from, const Vector2d& to) const;
+
+  [[nodiscard]] int GetWidth() const { return width_; }
+  [[nodiscard]] int GetHeight() const { return height_; }
+
+ private:
+  int width_{};
+  int height_{};
+  std::vector<uint8_t> distances_;
+};
+
+}  // namespace platformer
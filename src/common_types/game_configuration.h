@@ -10,6 +10,9 @@ struct Tile {
   int tile_id;
 };
 
+// Value of solid tiles in Level::property_grid.
+constexpr int kSolidProperty = 1;
+
 struct Level {
   Grid<int> property_grid;                 // Solid, water, lava etc.
   Grid<Tile> tile_grid;                    // Which tiles to draw.
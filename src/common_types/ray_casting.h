@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include "common_types/basic_types.h"
+
+namespace platformer {
+
+// Where a segment first crosses into a solid cell.
+struct GridCrossing {
+  double t;   // Fraction of the segment travelled, in [0, 1].
+  Axis axis;  // Axis of the cell boundary that was crossed.
+  int cell_x;
+  int cell_y;
+};
+
+// Walks the unit cells crossed by the segment start + t * delta, t in [0, 1], in order
+// (Amanatides & Woo, "A Fast Voxel Traversal Algorithm"). Costs O(cells crossed).
+// Returns the first boundary crossing into a cell for which is_solid(x, y) holds. The cell the
+// segment starts in is never reported.
+template <typename IsSolid>
+std::optional<GridCrossing> FindFirstSolidCrossing(const Vector2d& start,
+                                                   const Vector2d& delta,
+                                                   IsSolid&& is_solid) {
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+  int x = static_cast<int>(std::floor(start.x));
+  int y = static_cast<int>(std::floor(start.y));
+  const int step_x = delta.x > 0 ? 1 : (delta.x < 0 ? -1 : 0);
+  const int step_y = delta.y > 0 ? 1 : (delta.y < 0 ? -1 : 0);
+
+  // Fraction of the segment needed to cross one full cell, and to reach the next boundary.
+  const double t_delta_x = step_x != 0 ? std::abs(1. / delta.x) : kInf;
+  const double t_delta_y = step_y != 0 ? std::abs(1. / delta.y) : kInf;
+  double t_max_x = step_x > 0   ? (x + 1 - start.x) * t_delta_x
+                   : step_x < 0 ? (start.x - x) * t_delta_x
+                                : kInf;
+  double t_max_y = step_y > 0   ? (y + 1 - start.y) * t_delta_y
+                   : step_y < 0 ? (start.y - y) * t_delta_y
+                                : kInf;
+
+  while (true) {
+    GridCrossing crossing{};
+    if (t_max_x <= t_max_y) {
+      crossing.t = t_max_x;
+      crossing.axis = Axis::X;
+      x += step_x;
+      t_max_x += t_delta_x;
+    } else {
+      crossing.t = t_max_y;
+      crossing.axis = Axis::Y;
+      y += step_y;
+      t_max_y += t_delta_y;
+    }
+    if (crossing.t > 1.) {
+      return std::nullopt;
+    }
+    if (is_solid(x, y)) {
+      crossing.cell_x = x;
+      crossing.cell_y = y;
+      return crossing;
+    }
+  }
+}
+
+// Slab test. Returns the fraction of the segment start + t * delta, t in [0, 1], at which it
+// enters the box. Zero if it starts inside.
+inline std::optional<double> IntersectSegmentAabb(const Vector2d& start,
+                                                  const Vector2d& delta,
+                                                  const BoundingBox& box) {
+  double t_enter = 0.;
+  double t_exit = 1.;
+  const auto clip = [&](const double origin, const double direction, const double min,
+                        const double max) {
+    if (direction == 0.) {
+      return origin >= min && origin <= max;
+    }
+    double t_min = (min - origin) / direction;
+    double t_max = (max - origin) / direction;
+    if (t_min > t_max) {
+      std::swap(t_min, t_max);
+    }
+    t_enter = std::max(t_enter, t_min);
+    t_exit = std::min(t_exit, t_max);
+    return t_enter <= t_exit;
+  };
+  if (!clip(start.x, delta.x, box.left, box.right) ||
+      !clip(start.y, delta.y, box.bottom, box.top)) {
+    return std::nullopt;
+  }
+  return t_enter;
+}
+
+}  // namespace platformer
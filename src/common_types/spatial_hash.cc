@@ -0,0 +1,144 @@
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+void EraseFromCell(std::vector<EntityId>& cell, const EntityId id) {
+  auto itr = std::find(cell.begin(), cell.end(), id);
+  RB_CHECK(itr != cell.end());
+  *itr = cell.back();
+  cell.pop_back();
+}
+
+void SortUnique(std::vector<EntityId>& ids) {
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+}  // namespace
+
+SpatialHash::SpatialHash(const int width, const int height)
+    : width_{width}, height_{height}, cells_(width * height) {
+  RB_CHECK(width > 0 && height > 0);
+}
+
+int SpatialHash::ClampX(const double x) const {
+  return std::clamp(static_cast<int>(std::floor(x)), 0, width_ - 1);
+}
+
+int SpatialHash::ClampY(const double y) const {
+  return std::clamp(static_cast<int>(std::floor(y)), 0, height_ - 1);
+}
+
+SpatialHash::CellRange SpatialHash::GetCellRange(const BoundingBox& box) const {
+  return {ClampX(box.left), ClampY(box.bottom), ClampX(box.right), ClampY(box.top)};
+}
+
+void SpatialHash::Update(const EntityId id, const BoundingBox& box) {
+  const auto new_range = GetCellRange(box);
+  auto itr = entity_cells_.find(id);
+  if (itr == entity_cells_.end()) {
+    for (int y = new_range.min_y; y <= new_range.max_y; ++y) {
+      for (int x = new_range.min_x; x <= new_range.max_x; ++x) {
+        GetCellMutable(x, y).push_back(id);
+      }
+    }
+    entity_cells_.emplace(id, new_range);
+    return;
+  }
+
+  const auto old_range = itr->second;
+  if (old_range == new_range) {
+    return;
+  }
+  // Only touch the cells the entity left or entered.
+  for (int y = old_range.min_y; y <= old_range.max_y; ++y) {
+    for (int x = old_range.min_x; x <= old_range.max_x; ++x) {
+      if (!new_range.Contains(x, y)) {
+        EraseFromCell(GetCellMutable(x, y), id);
+      }
+    }
+  }
+  for (int y = new_range.min_y; y <= new_range.max_y; ++y) {
+    for (int x = new_range.min_x; x <= new_range.max_x; ++x) {
+      if (!old_range.Contains(x, y)) {
+        GetCellMutable(x, y).push_back(id);
+      }
+    }
+  }
+  itr->second = new_range;
+}
+
+void SpatialHash::Remove(const EntityId id) {
+  auto itr = entity_cells_.find(id);
+  if (itr == entity_cells_.end()) {
+    return;
+  }
+  const auto range = itr->second;
+  for (int y = range.min_y; y <= range.max_y; ++y) {
+    for (int x = range.min_x; x <= range.max_x; ++x) {
+      EraseFromCell(GetCellMutable(x, y), id);
+    }
+  }
+  entity_cells_.erase(itr);
+}
+
+void SpatialHash::Clear() {
+  for (auto& cell : cells_) {
+    cell.clear();
+  }
+  entity_cells_.clear();
+}
+
+std::vector<EntityId> SpatialHash::GetEntities() const {
+  std::vector<EntityId> ids;
+  ids.reserve(entity_cells_.size());
+  for (const auto& [id, _] : entity_cells_) {
+    ids.push_back(id);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+std::vector<EntityId> SpatialHash::QueryAabb(const BoundingBox& box) const {
+  std::vector<EntityId> out;
+  QueryAabb(box, out);
+  return out;
+}
+
+void SpatialHash::QueryAabb(const BoundingBox& box, std::vector<EntityId>& out) const {
+  out.clear();
+  const auto range = GetCellRange(box);
+  for (int y = range.min_y; y <= range.max_y; ++y) {
+    for (int x = range.min_x; x <= range.max_x; ++x) {
+      const auto& cell = GetCell(x, y);
+      out.insert(out.end(), cell.begin(), cell.end());
+    }
+  }
+  SortUnique(out);
+}
+
+std::vector<EntityId> SpatialHash::QueryPoint(const double x, const double y) const {
+  std::vector<EntityId> out;
+  QueryPoint(x, y, out);
+  return out;
+}
+
+void SpatialHash::QueryPoint(const double x, const double y, std::vector<EntityId>& out) const {
+  const auto& cell = GetCell(ClampX(x), ClampY(y));
+  out.assign(cell.begin(), cell.end());
+  std::sort(out.begin(), out.end());
+}
+
+const std::vector<EntityId>& SpatialHash::GetCell(const int x, const int y) const {
+  RB_CHECK(x >= 0 && y >= 0 && x < width_ && y < height_);
+  return cells_[y * width_ + x];
+}
+
+}  // namespace platformer
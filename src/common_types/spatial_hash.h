@@ -0,0 +1,71 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common_types/basic_types.h"
+#include "common_types/entity.h"
+
+namespace platformer {
+
+// Broadphase for entity bounding boxes: a dense grid of tile sized cells, each listing every
+// entity overlapping it.
+//
+// Entities are updated incrementally, an entity that stays within the same cells costs one
+// comparison. Boxes partially or fully outside the grid are clamped to the border cells, so
+// queries never miss an entity, but like any broadphase they return candidates. Callers do the
+// exact test.
+class SpatialHash {
+ public:
+  SpatialHash() = default;
+  SpatialHash(int width, int height);
+
+  // Inserts the entity, or moves it if it is already present.
+  void Update(EntityId id, const BoundingBox& box);
+  void Remove(EntityId id);
+  void Clear();
+
+  [[nodiscard]] bool Contains(EntityId id) const { return entity_cells_.count(id) != 0; }
+  [[nodiscard]] int GetNumEntities() const { return static_cast<int>(entity_cells_.size()); }
+  [[nodiscard]] std::vector<EntityId> GetEntities() const;
+
+  // Entities whose cells overlap the box / contain the point. Sorted, without duplicates.
+  // The overloads taking `out` clear it and reuse its memory.
+  [[nodiscard]] std::vector<EntityId> QueryAabb(const BoundingBox& box) const;
+  void QueryAabb(const BoundingBox& box, std::vector<EntityId>& out) const;
+  [[nodiscard]] std::vector<EntityId> QueryPoint(double x, double y) const;
+  void QueryPoint(double x, double y, std::vector<EntityId>& out) const;
+
+  [[nodiscard]] const std::vector<EntityId>& GetCell(int x, int y) const;
+  [[nodiscard]] int GetWidth() const { return width_; }
+  [[nodiscard]] int GetHeight() const { return height_; }
+
+ private:
+  // Inclusive range of cells.
+  struct CellRange {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+
+    bool operator==(const CellRange& other) const {
+      return min_x == other.min_x && min_y == other.min_y && max_x == other.max_x &&
+             max_y == other.max_y;
+    }
+    bool Contains(int x, int y) const {
+      return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+    }
+  };
+
+  [[nodiscard]] CellRange GetCellRange(const BoundingBox& box) const;
+  [[nodiscard]] int ClampX(double x) const;
+  [[nodiscard]] int ClampY(double y) const;
+  std::vector<EntityId>& GetCellMutable(int x, int y) { return cells_[y * width_ + x]; }
+
+  int width_{};
+  int height_{};
+  std::vector<std::vector<EntityId>> cells_;
+  std::unordered_map<EntityId, CellRange> entity_cells_;
+};
+
+}  // namespace platformer
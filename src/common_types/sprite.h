@@ -1,16 +1,45 @@
 #pragma once
 
+#include <algorithm>
+
 namespace olc {
 class Sprite;
 }
 
 namespace platformer {
 
+class SpriteSpans;
+
 struct Sprite {
   const olc::Sprite* sprite_ptr;
   // Offset is measured from the bottom right
   int draw_offset_x{};
   int draw_offset_y{};
+  // Built at load time. Sprites without spans are drawn by the engine.
+  const SpriteSpans* spans{};
+};
+
+// How far a sprite reaches from the pixel it is drawn at, y down: it covers the pixels
+// [x - left, x + right) and [y - up, y + down).
+struct SpriteExtent {
+  int left{};
+  int right{};
+  int up{};
+  int down{};
 };
 
+// The extent of a width x height image drawn with the offsets of a Sprite.
+inline SpriteExtent GetSpriteExtent(const int width,
+                                    const int height,
+                                    const int draw_offset_x,
+                                    const int draw_offset_y) {
+  return {draw_offset_x, width - draw_offset_x, height - draw_offset_y, draw_offset_y};
+}
+
+// The smallest extent that covers both.
+inline SpriteExtent Union(const SpriteExtent& lhs, const SpriteExtent& rhs) {
+  return {std::max(lhs.left, rhs.left), std::max(lhs.right, rhs.right), std::max(lhs.up, rhs.up),
+          std::max(lhs.down, rhs.down)};
+}
+
 }  // namespace platformer
\ No newline at end of file
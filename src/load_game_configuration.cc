@@ -8,13 +8,14 @@
 #include "common_types/grid.h"
 #include "common_types/tileset.h"
 #include "nlohmann/json.hpp"
+#include "utils/job_system.h"
 #include "utils/logging.h"
 
 using json = nlohmann::json;
 
 namespace platformer {
 
-std::shared_ptr<TileSet> LoadTileSet(const json& tileset_json) {
+std::shared_ptr<TileSet> LoadTileSet(const json& tileset_json, JobSystem* job_system) {
   const int width = tileset_json["__cWid"];
   const int height = tileset_json["__cHei"];
   const int tile_size = tileset_json["tileGridSize"];
@@ -25,8 +26,10 @@ std::shared_ptr<TileSet> LoadTileSet(const json& tileset_json) {
 
   const std::string path_from_config = tileset_json["relPath"];
   const auto tile_path = std::filesystem::path(SOURCE_DIR) / path_from_config;
-  olc::Sprite tileset_img(tile_path.string());
-  for (int y = 0; y < height; ++y) {
+  const olc::Sprite tileset_img(tile_path.string());
+  // Every row of tiles is independent: the source image is only read, and each tile is written to
+  // its own slot.
+  const auto slice_row = [&](const int y) {
     for (int x = 0; x < width; ++x) {
       auto tile = std::make_unique<olc::Sprite>(tile_size, tile_size);
       for (int j = 0; j < tile_size; ++j) {
@@ -36,6 +39,13 @@ std::shared_ptr<TileSet> LoadTileSet(const json& tileset_json) {
       }
       tileset_ptr->SetTile(x, y, std::move(tile));
     }
+  };
+  if (job_system != nullptr) {
+    job_system->ParallelFor(0, height, slice_row);
+  } else {
+    for (int y = 0; y < height; ++y) {
+      slice_row(y);
+    }
   }
   return tileset_ptr;
 }
@@ -81,7 +91,8 @@ Grid<int> LoadIntGrid(const json& intgrid_json) {
   return tiles;
 }
 
-std::optional<GameConfiguration> LoadGameConfiguration(const std::string& path) {
+std::optional<GameConfiguration> LoadGameConfiguration(const std::string& path,
+                                                       JobSystem* job_system) {
   std::ifstream file_in(path);
   if (!file_in.is_open()) {
     std::cerr << "Failed to open file.\n";
@@ -94,7 +105,7 @@ std::optional<GameConfiguration> LoadGameConfiguration(const std::string& path)
   LOG_SIMPLE("Loading Tilesets:");
   for (const auto& tileset_json : ldtk["defs"]["tilesets"]) {
     const int uid = tileset_json["uid"];
-    config.tilesets[uid] = LoadTileSet(tileset_json);
+    config.tilesets[uid] = LoadTileSet(tileset_json, job_system);
   }
 
   LOG_SIMPLE("Loading Levels:");
@@ -3,9 +3,12 @@
 #include <optional>
 
 #include "common_types/game_configuration.h"
+#include "utils/job_system.h"
 
 namespace platformer {
 
-std::optional<GameConfiguration> LoadGameConfiguration(const std::string& path);
+// If a job system is given, the tilesets are sliced into tiles in parallel.
+std::optional<GameConfiguration> LoadGameConfiguration(const std::string& path,
+                                                       JobSystem* job_system = nullptr);
 
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 #include <memory>
 
 #include "animation/animated_sprite.h"
-#include "animation/simple_sprites.h"
 #include "animation/sprite_manager.h"
 #include "common_types/actor_state.h"
 #include "common_types/components.h"
@@ -97,12 +96,22 @@ std::shared_ptr<ParameterServer> CreateParameterServer() {
 
   parameter_server->AddParameter("debug/enable.timing", 0., "Spam the console with timing debug");
 
+  parameter_server->AddParameter(
+      "threading/pipelined.simulation", 0.,
+      "If 1, simulate the next frame on a worker thread while the current frame is rendered.");
+
+  parameter_server->AddParameter(
+      "threading/num.workers", static_cast<double>(JobSystem::DefaultNumWorkers()),
+      "Number of worker threads of the job system (0 = run all jobs on the calling thread). "
+      "Only read at startup.");
+
   return parameter_server;
 }
 
 std::shared_ptr<SpriteManager> InitializeAnimationManager(const ParameterServer& parameter_server,
                                                           EntityId player_id,
-                                                          std::shared_ptr<Registry> registry) {
+                                                          std::shared_ptr<Registry> registry,
+                                                          JobSystem& job_system) {
   const auto player_path = std::filesystem::path(SOURCE_DIR) / "assets" / "player";
   constexpr int kWidth = 80;
   std::vector<AnimationInfo> animations = {
@@ -131,16 +140,22 @@ std::shared_ptr<SpriteManager> InitializeAnimationManager(const ParameterServer&
       {player_path / "player_hit_dead.png", false, 0, -1, -1, false, State::Dying},
   };
 
-  auto animation_manager = std::make_shared<SpriteManager>(std::move(registry));
-  for (const auto& animation : animations) {
-    auto animated_sprite = AnimatedSprite::CreateAnimatedSprite(
+  // Decoding the sprite sheets dominates startup, load them all in parallel.
+  std::vector<std::optional<AnimatedSprite>> animated_sprites(animations.size());
+  job_system.ParallelFor(0, static_cast<int>(animations.size()), [&](const int i) {
+    const auto& animation = animations[i];
+    animated_sprites[i] = AnimatedSprite::CreateAnimatedSprite(
         animation.sprite_path, animation.loops, animation.start_frame_idx, animation.end_frame_idx,
         animation.intro_frames, animation.forwards_backwards);
-    if (!animated_sprite.has_value()) {
+  });
+
+  auto animation_manager = std::make_shared<SpriteManager>(std::move(registry));
+  for (size_t i = 0; i < animations.size(); ++i) {
+    if (!animated_sprites[i].has_value()) {
       return nullptr;
     }
-    animation_manager->AddAnimation(MakeKey(Actor::Player, animation.state),
-                                    std::move(*animated_sprite));
+    animation_manager->AddAnimation(MakeKey(Actor::Player, animations[i].state),
+                                    std::move(*animated_sprites[i]));
   }
 
   // Bullet
@@ -163,9 +178,6 @@ std::shared_ptr<SpriteManager> InitializeAnimationManager(const ParameterServer&
     animation_manager->AddAnimation("bullet_v_01", std::move(*animated_sprite));
   }
 
-  // shotgun pellet
-  animation_manager->AddSprite("pellet", 1, 2, CreateShotgunPelletSprite());
-
   animation_manager->AddInsideSpriteLocation(MakePlayerKey(State::BackDodgeShot), {58, 12});
   animation_manager->AddInsideSpriteLocation(MakePlayerKey(State::BackShot), {9, 27});
   animation_manager->AddInsideSpriteLocation(MakePlayerKey(State::CrouchShot), {62, 19});
@@ -220,31 +232,40 @@ Platformer::Platformer() : parameter_server_{CreateParameterServer()}, rate_(kGa
   this->Construct(kScreenWidthPx, kScreenHeightPx, kPixelSize, kPixelSize);
 }
 
-bool Platformer::OnUserDestroy() { return true; }
+bool Platformer::OnUserDestroy() {
+  WaitForSimulation();
+  return true;
+}
 
 bool Platformer::OnUserCreate() {
   this->SetPixelMode(olc::Pixel::Mode::ALPHA);
 
   rng_ = std::make_shared<RandomNumberGenerator>(RandomNumberGenerator::Mode::Hardware);
+  job_system_ = std::make_shared<JobSystem>(
+      static_cast<int>(parameter_server_->GetParameter<double>("threading/num.workers")));
 
   // TODO(BT-02): Path is assumed to be cmake source. Store assets in the binary.
   const auto levels_path = std::filesystem::path(SOURCE_DIR) / "levels.json";
-  auto config = platformer::LoadGameConfiguration(levels_path.string());
+  auto config = platformer::LoadGameConfiguration(levels_path.string(), job_system_.get());
   RETURN_FALSE_IF_FAILED(config);
   config_ = std::move(*config);
   level_idx_ = 0;
 
   registry_ = std::make_shared<Registry>();
+  registry_->OnAdded<TimeToDespawn>([this](EntityId id, const TimeToDespawn& time_to_despawn) {
+    ScheduleDespawn(id, time_to_despawn.time_to_despawn);
+  });
   player_id_ = InitializePlayer(*registry_);
 
   LOG_SIMPLE("Loading sprites...");
-  animation_manager_ = InitializeAnimationManager(*parameter_server_, player_id_, registry_);
+  animation_manager_ =
+      InitializeAnimationManager(*parameter_server_, player_id_, registry_, *job_system_);
   RETURN_FALSE_IF_FAILED(animation_manager_);
   SetAnimationCallbacks(*animation_manager_);
 
   LOG_SIMPLE("Loading backgrounds...");
   rendering_system_ = std::make_unique<RenderingSystem>(this, GetCurrentLevel(), parameter_server_,
-                                                        animation_manager_, registry_);
+                                                        animation_manager_, registry_, job_system_);
   const auto background_path = std::filesystem::path(SOURCE_DIR) / "assets" / "backgrounds";
   RETURN_FALSE_IF_FAILED(
       rendering_system_->AddBackgroundLayer(background_path / "background.png", 4));
@@ -257,26 +278,34 @@ bool Platformer::OnUserCreate() {
 
   developer_console_ = std::make_shared<DeveloperConsole>(parameter_server_, registry_);
   physics_system_ =
-      std::make_unique<PhysicsSystem>(GetCurrentLevel(), parameter_server_, registry_);
+      std::make_unique<PhysicsSystem>(GetCurrentLevel(), parameter_server_, job_system_, registry_);
   input_processor_ =
       std::make_unique<InputProcessor>(parameter_server_, developer_console_, registry_, this);
   projectile_system_ =
       std::make_unique<ProjectileSystem>(parameter_server_, animation_manager_, rng_, registry_,
-                                         GetCurrentLevel().level_tileset->GetTileSize());
+                                         GetCurrentLevel());
+  particle_system_ =
+      std::make_unique<ParticleSystem>(GetCurrentLevel(), parameter_server_, rng_, job_system_);
+  simulation_scheduler_ = std::make_unique<SystemScheduler>(job_system_);
+  AddSimulationSystems();
 
   LOG_SIMPLE("Initialization successful.");
   rate_.Reset();
   return true;
 }
 
-// Move this elsewhere
-void Platformer::RemoveComponentsWithTimeToLive() {
-  for (EntityId id : registry_->GetView<TimeToDespawn>()) {
-    const auto& time_to_die = registry_->GetComponent<TimeToDespawn>(id).time_to_despawn;
-    if (GameClock::NowGlobal() > time_to_die) {
-      registry_->RemoveComponent(id);
+void Platformer::ScheduleDespawn(const EntityId id, const TimePoint time_to_despawn) {
+  timers_.Schedule(time_to_despawn, [this, id] {
+    if (!registry_->HasComponent<TimeToDespawn>(id)) {
+      return;  // Removed already.
     }
-  }
+    const auto time_to_die = registry_->GetComponent<TimeToDespawn>(id).time_to_despawn;
+    if (GameClock::NowGlobal() < time_to_die) {
+      ScheduleDespawn(id, time_to_die);  // Postponed since it was scheduled.
+      return;
+    }
+    registry_->RemoveComponent(id);
+  });
 }
 
 void Platformer::UpdateAnimatedSpriteComponentFromState() {
@@ -305,8 +334,108 @@ void Platformer::ProcessCollisionEvents(const std::vector<CollisionEvent>& colli
   }
 }
 
+void Platformer::AddSimulationSystems() {
+  auto& scheduler = *simulation_scheduler_;
+
+  // Model
+  scheduler.AddSystem(
+      "animation_events",
+      SystemAccess{}.Writes<AnimatedSpriteComponent>().WritesResource("animation_events"),
+      [this] { animation_events_ = animation_manager_->GetAnimationEvents(); });
+  scheduler.AddSystem(
+      "sound", SystemAccess{}.ReadsResource("animation_events").WritesResource("audio"),
+      [this] { sound_processor_->ProcessAnimationEvents(animation_events_); });
+  scheduler.AddSystem(
+      "player_state",
+      SystemAccess{}
+          .Reads<PlayerComponent, Position, Velocity, CollisionBox, Collision>()
+          .Writes<StateComponent, FacingDirection, DistanceFallen>()
+          .ReadsResource("animation_events"),
+      [this] {
+        UpdatePlayerState(*parameter_server_, animation_events_, *physics_system_, *registry_);
+      });
+  scheduler.AddSystem(
+      "facing_direction",
+      SystemAccess{}.Reads<Acceleration, StateComponent>().Writes<FacingDirection>(),
+      [this] { SetFacingDirection(*registry_); });
+  scheduler.AddSystem(
+      "components_from_state", SystemAccess{}.Reads<StateComponent>().Writes<Velocity>(),
+      [this] { UpdateComponentsFromState(*parameter_server_, *registry_); });
+  scheduler.AddSystem(
+      "player_components_from_state",
+      SystemAccess{}
+          .Reads<StateComponent, Collision>()
+          .Writes<PlayerComponent, Velocity, Acceleration, FacingDirection, CollisionBox>()
+          .ReadsResource("animation_events"),
+      [this] {
+        UpdatePlayerComponentsFromState(*parameter_server_, animation_events_, *registry_);
+      });
+  scheduler.AddSystem(
+      "animated_sprite_from_state",
+      SystemAccess{}.Reads<StateComponent>().Writes<AnimatedSpriteComponent>(),
+      [this] { UpdateAnimatedSpriteComponentFromState(); });
+  scheduler.AddSystem(
+      "spawn_projectiles",
+      SystemAccess{}.Structural().ReadsResource("animation_events").WritesResource("rng"),
+      [this] { projectile_system_->SpawnProjectiles(animation_events_, *physics_system_); });
+  scheduler.AddSystem("timers", SystemAccess{}.Structural(),
+                      [this] { timers_.RunDue(GameClock::NowGlobal()); });
+
+  // Physics
+  scheduler.AddSystem("gravity", SystemAccess{}.Writes<Acceleration>(),
+                      [this] { physics_system_->ApplyGravity(); });
+  scheduler.AddSystem(
+      "friction",
+      SystemAccess{}.Reads<Acceleration, Position, Collision, StateComponent>().Writes<Velocity>(),
+      [this] { physics_system_->ApplyFriction(simulation_delta_t_); });
+  scheduler.AddSystem(
+      "physics_step",
+      SystemAccess{}.Structural().WritesResource("broadphase").WritesResource("ricochets"),
+      [this] { physics_system_->PhysicsStep(simulation_delta_t_); });
+  scheduler.AddSystem("particles",
+                      SystemAccess{}
+                          .ReadsResource("ricochets")
+                          .WritesResource("particles")
+                          .WritesResource("rng"),
+                      [this] {
+                        particle_system_->SpawnRicochets(physics_system_->GetRicochets());
+                        particle_system_->Update(simulation_delta_t_);
+                      });
+  scheduler.AddSystem(
+      "distance_fallen", SystemAccess{}.Reads<Velocity>().Writes<DistanceFallen>(),
+      [this] { physics_system_->SetDistanceFallen(simulation_delta_t_); });
+  scheduler.AddSystem(
+      "projectile_collisions",
+      SystemAccess{}
+          .Reads<Position, CollisionBox, Projectile>()
+          .ReadsResource("broadphase")
+          .WritesResource("collision_events"),
+      [this] { collision_events_ = physics_system_->DetectProjectileCollisions(); });
+  scheduler.AddSystem(
+      "collision_events", SystemAccess{}.Structural().ReadsResource("collision_events"),
+      [this] { ProcessCollisionEvents(collision_events_); });
+  scheduler.AddSystem(
+      "projectile_lifetime", SystemAccess{}.Structural().ReadsResource("ricochets"),
+      [this] { projectile_system_->RemoveExpiredProjectiles(physics_system_->GetRicochets()); });
+}
+
+void Platformer::Simulate(const double delta_t) {
+  simulation_profiler_.Reset();
+  simulation_delta_t_ = delta_t;
+  simulation_scheduler_->Run();
+  simulation_profiler_.LogEvent("01_simulation");
+}
+
+void Platformer::WaitForSimulation() { simulation_worker_.Wait(); }
+
 bool Platformer::OnUserUpdate(float fElapsedTime) {
   const double delta_t = std::chrono::duration<double>(rate_.GetFrameDuration()).count();
+  const bool pipelined =
+      parameter_server_->GetParameter<double>("threading/pipelined.simulation") > 0;
+
+  // In pipelined mode the previous frame was simulated while its predecessor was rendered.
+  // Everything below until the next simulation is submitted has exclusive access to the registry.
+  WaitForSimulation();
   profiler_.Reset();
 
   // Control
@@ -318,43 +447,46 @@ bool Platformer::OnUserUpdate(float fElapsedTime) {
     return true;
   }
 
-  // Model
-  const auto events = animation_manager_->GetAnimationEvents();
-  sound_processor_->ProcessAnimationEvents(events);
-  UpdatePlayerState(*parameter_server_, events, *physics_system_, *registry_);
-  SetFacingDirection(*registry_);
-  UpdateComponentsFromState(*parameter_server_, *registry_);
-  UpdatePlayerComponentsFromState(*parameter_server_, events, *registry_);
-  UpdateAnimatedSpriteComponentFromState();
-  projectile_system_->SpawnProjectiles(events);
-  RemoveComponentsWithTimeToLive();
-  profiler_.LogEvent("01_update_states");
-
-  physics_system_->ApplyGravity();
-  physics_system_->ApplyFriction(delta_t);
-  physics_system_->PhysicsStep(delta_t);
-  physics_system_->SetDistanceFallen(delta_t);
-  const auto collision_events = physics_system_->DetectProjectileCollisions();
-  ProcessCollisionEvents(collision_events);
-  profiler_.LogEvent("02_physics");
-
-  // View
-  rendering_system_->KeepPlayerInFrame(player_id_);
-  rendering_system_->RenderBackground();
-  rendering_system_->RenderTiles();
-  rendering_system_->RenderEntities();
-  rendering_system_->RenderForeground();
-  // rendering_system_->RenderOccupancyGrid(physics_system_->GetOccupancyGrid());
+  if (pipelined) {
+    rendering_system_->KeepPlayerInFrame(player_id_);
+    const auto snapshot = CaptureSnapshot();
+    simulation_worker_.Submit([this, delta_t] { Simulate(delta_t); });
+    profiler_.Reset();
+    Render(snapshot);
+  } else {
+    Simulate(delta_t);
+    profiler_.Reset();
+    rendering_system_->KeepPlayerInFrame(player_id_);
+    Render(CaptureSnapshot());
+  }
   profiler_.LogEvent("03_render");
 
   if (parameter_server_->GetParameter<double>("debug/enable.timing") > 0) {
+    // Simulation timings are only read while no simulation is in flight.
+    WaitForSimulation();
+    simulation_profiler_.PrintTimings();
     profiler_.PrintTimings();
+    std::cout << ToString(rate_.GetJitterStatistics()) << std::endl;
   }
   rate_.Sleep(false);
   return true;
 }
 
+RenderSnapshot Platformer::CaptureSnapshot() {
+  auto snapshot = rendering_system_->CaptureSnapshot();
+  particle_system_->Capture(snapshot.particles);
+  return snapshot;
+}
+
+void Platformer::Render(const RenderSnapshot& snapshot) {
+  // View
+  rendering_system_->RenderFrame(snapshot);
+  // rendering_system_->RenderOccupancyGrid(physics_system_->GetBroadphase());
+}
+
 bool Platformer::OnConsoleCommand(const std::string& sCommand) {
+  // Console commands act directly on the registry.
+  WaitForSimulation();
   const bool success = developer_console_->ProcessCommandLine(sCommand);
   // Do not return false here, it will end the application.
   return true;
@@ -7,17 +7,23 @@
 #include "input/input_processor.h"
 #include "olcPixelGameEngine.h"
 #include "registry.h"
+#include "rendering/render_snapshot.h"
 #include "sound/sound_player.h"
 #include "sound/sound_processor.h"
 #include "systems/developer_console.h"
+#include "systems/particle_system.h"
 #include "systems/physics_system.h"
 #include "systems/projectile_system.h"
 #include "systems/rendering_system.h"
+#include "systems/system_scheduler.h"
+#include "utils/job_system.h"
 #include "utils/parameter_server.h"
 #include "utils/random_number_generator.h"
 #include "utils/rate_timer.h"
 #include "utils/simple_profiler.h"
+#include "utils/timer_queue.h"
 #include "utils/windows_high_res_timer.h"
+#include "utils/worker_thread.h"
 
 namespace platformer {
 
@@ -33,10 +39,21 @@ class Platformer : public olc::PixelGameEngine {
   bool Keyboard();
   Level& GetCurrentLevel() { return config_.levels.at(level_idx_); };
 
-  void RemoveComponentsWithTimeToLive();
+  // Removes the entity once its TimeToDespawn is reached.
+  void ScheduleDespawn(EntityId id, TimePoint time_to_despawn);
   void UpdateAnimatedSpriteComponentFromState();
   void ProcessCollisionEvents(const std::vector<CollisionEvent>& collision_events);
 
+  // Registers the simulation systems with the scheduler, in their serial order.
+  void AddSimulationSystems();
+
+  // Everything between input processing and rendering: state updates, spawning and physics.
+  void Simulate(double delta_t);
+  void WaitForSimulation();
+  // Copies everything rendering needs out of the registry and the particle system.
+  RenderSnapshot CaptureSnapshot();
+  void Render(const RenderSnapshot& snapshot);
+
   GameConfiguration config_;
   int level_idx_;
   // TODO(BT-03):: Remove all unique ptrs. They are like this for delayed initialization
@@ -52,18 +69,33 @@ class Platformer : public olc::PixelGameEngine {
   std::shared_ptr<SpriteManager> animation_manager_;
   std::shared_ptr<RandomNumberGenerator> rng_;
   std::unique_ptr<ProjectileSystem> projectile_system_;
+  std::unique_ptr<ParticleSystem> particle_system_;
   std::shared_ptr<DeveloperConsole> developer_console_;
+  std::shared_ptr<JobSystem> job_system_;
+  std::unique_ptr<SystemScheduler> simulation_scheduler_;
+
+  // State handed between the simulation systems within a frame.
+  double simulation_delta_t_{};
+  std::vector<AnimationEvent> animation_events_;
+  std::vector<CollisionEvent> collision_events_;
+  // Delayed actions, run by the simulation in game time: despawns, state changes, reloads etc.
+  TimerQueue timers_;
 
   std::map<std::string, olc::Sprite*> static_sprite_storage_;
 
   RateTimer rate_;
-  SimpleProfiler profiler_;
+  SimpleProfiler profiler_;             // Main thread: control and rendering.
+  SimpleProfiler simulation_profiler_;  // Model and physics, possibly on the worker thread.
 
   EntityId player_id_;
 
 #ifdef _WIN32
   WindowsHighResTimer high_res_timer_{1};
 #endif
+
+  // Runs Simulate() in pipelined mode.
+  // Declared last so it is joined before any of the state the simulation uses is destroyed.
+  WorkerThread simulation_worker_;
 };
 
 }  // namespace platformer
\ No newline at end of file
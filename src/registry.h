@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common_types/components.h"
 #include "common_types/entity.h"
@@ -54,16 +57,28 @@ class Registry {
   EntityId AddComponents(Args&&... args) {
     EntityId id = next_id_++;
     ((internal::GetByType<std::decay_t<Args>>(maps_tuple_)[id] = std::forward<Args>(args)), ...);
+    (NotifyAdded<std::decay_t<Args>>(id), ...);
     return id;
   }
 
+  // Calls the callback for every entity added with this component, right after it was added.
+  // Usage:
+  // registry.OnAdded<TimeToDespawn>([](EntityId id, const TimeToDespawn& time_to_despawn) {
+  //     ...
+  // });
+  template <typename Component>
+  void OnAdded(std::function<void(EntityId, const Component&)> callback) {
+    GetAddedCallbacks<Component>().push_back(std::move(callback));
+  }
+
   // Usage:
   // auto [pos, vel, acc] = registry.GetComponents<Position, Velocity, Acceleration>(id);
   // These are still references even though the auto is without an ampersand.
+  // Lookups use at(), not operator[], so systems may read the same maps concurrently.
   template <typename... Components>
   auto GetComponents(EntityId id) {
     RB_CHECK((HasComponent<Components>(id) && ...));
-    return std::tie(GetMap<Components>()[id]...);
+    return std::tie(GetMap<Components>().at(id)...);
   }
 
   template <typename... Components>
@@ -82,7 +97,7 @@ class Registry {
   auto& GetComponent(EntityId id) {
     auto& map = GetMap<T>();
     RB_CHECK(map.count(id));
-    return map[id];
+    return map.at(id);
   }
 
   template <typename T>
@@ -97,6 +112,15 @@ class Registry {
     return GetComponent<T>(id);
   }
 
+  // Each component type has a fixed index in [0, GetNumComponentTypes()).
+  // Used to describe sets of component types as bit masks.
+  static constexpr size_t GetNumComponentTypes() { return std::tuple_size_v<MapsTuple>; }
+
+  template <typename Component>
+  static constexpr size_t GetComponentIndex() {
+    return internal::MapIndex<Component, MapsTuple>::value;
+  }
+
   // Removes the id from all component maps.
   void RemoveComponent(EntityId id) {
     std::apply([&](auto&&... args) { RemoveComponentImpl(id, args...); }, maps_tuple_);
@@ -108,29 +132,46 @@ class Registry {
     ((args.erase(id)), ...);
   }
 
+  template <typename Component>
+  auto& GetAddedCallbacks() {
+    return std::get<GetComponentIndex<Component>()>(added_callbacks_);
+  }
+
+  template <typename Component>
+  void NotifyAdded(EntityId id) {
+    for (const auto& callback : GetAddedCallbacks<Component>()) {
+      callback(id, GetMap<Component>().at(id));
+    }
+  }
+
+  using MapsTuple = std::tuple<std::unordered_map<EntityId, Position>,
+                               std::unordered_map<EntityId, Velocity>,
+                               std::unordered_map<EntityId, Acceleration>,
+                               std::unordered_map<EntityId, CollisionBox>,
+                               std::unordered_map<EntityId, Collision>,
+                               std::unordered_map<EntityId, FacingDirection>,
+                               std::unordered_map<EntityId, StateComponent>,
+                               std::unordered_map<EntityId, PlayerComponent>,
+                               std::unordered_map<EntityId, AnimatedSpriteComponent>,
+                               std::unordered_map<EntityId, SpriteComponent>,
+                               std::unordered_map<EntityId, PrimitiveComponent>,
+                               std::unordered_map<EntityId, DistanceFallen>,
+                               std::unordered_map<EntityId, Projectile>,
+                               std::unordered_map<EntityId, TimeToDespawn>>;
+
   EntityId next_id_{1};  // Zero is reserved.
-  std::tuple<std::unordered_map<EntityId, Position>,
-             std::unordered_map<EntityId, Velocity>,
-             std::unordered_map<EntityId, Acceleration>,
-             std::unordered_map<EntityId, CollisionBox>,
-             std::unordered_map<EntityId, Collision>,
-             std::unordered_map<EntityId, FacingDirection>,
-             std::unordered_map<EntityId, StateComponent>,
-             std::unordered_map<EntityId, PlayerComponent>,
-             std::unordered_map<EntityId, AnimatedSpriteComponent>,
-             std::unordered_map<EntityId, SpriteComponent>,
-             std::unordered_map<EntityId, DrawFunction>,
-             std::unordered_map<EntityId, DistanceFallen>,
-             std::unordered_map<EntityId, Projectile>,
-             std::unordered_map<EntityId, Particle>,
-             std::unordered_map<EntityId, TimeToDespawn>>
-      maps_tuple_;
+  MapsTuple maps_tuple_;
+  internal::AddedCallbacks<MapsTuple>::type added_callbacks_;
 };
 
+// The sorted union of views, i.e. of sorted vectors of ids.
 template <typename... Vecs>
-std::set<EntityId> CombineViews(const Vecs&... vecs) {
-    std::set<EntityId> out;
-    (out.insert(vecs.begin(), vecs.end()), ...);
+std::vector<EntityId> CombineViews(const Vecs&... vecs) {
+    std::vector<EntityId> out;
+    out.reserve((vecs.size() + ...));
+    (out.insert(out.end(), vecs.begin(), vecs.end()), ...);
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
     return out;
 }
 
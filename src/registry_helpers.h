@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -39,5 +42,26 @@ decltype(auto) GetByType(Tuple& t) {
   return std::get<std::unordered_map<EntityId, Component>>(t);
 }
 
+// Position of the map storing Component in the registry tuple.
+template <typename Component, typename Tuple>
+struct MapIndex;
+
+template <typename Component, typename... Maps>
+struct MapIndex<Component, std::tuple<std::unordered_map<EntityId, Component>, Maps...>>
+    : std::integral_constant<size_t, 0> {};
+
+template <typename Component, typename Map, typename... Maps>
+struct MapIndex<Component, std::tuple<Map, Maps...>>
+    : std::integral_constant<size_t, 1 + MapIndex<Component, std::tuple<Maps...>>::value> {};
+
+// For a tuple of component maps, a tuple with a list of callbacks per component type.
+template <typename Tuple>
+struct AddedCallbacks;
+
+template <typename... Components>
+struct AddedCallbacks<std::tuple<std::unordered_map<EntityId, Components>...>> {
+  using type = std::tuple<std::vector<std::function<void(EntityId, const Components&)>>...>;
+};
+
 }  // namespace internal
 }  // namespace platformer
\ No newline at end of file
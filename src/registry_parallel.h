@@ -0,0 +1,50 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+
+#include "common_types/entity.h"
+#include "registry.h"
+#include "utils/job_system.h"
+
+namespace platformer {
+
+// Below this many entities a pass is not worth spreading over threads.
+constexpr int kDefaultEntityGrainSize = 256;
+
+// Pointers to the components of each entity in ids, in the same order.
+// The registry maps are not thread safe, so jobs should work on these instead of the registry.
+template <typename... Components>
+std::vector<std::tuple<Components*...>> ResolveComponents(Registry& registry,
+                                                          const std::vector<EntityId>& ids) {
+  std::vector<std::tuple<Components*...>> components;
+  components.reserve(ids.size());
+  for (const auto id : ids) {
+    components.emplace_back(&registry.GetComponent<Components>(id)...);
+  }
+  return components;
+}
+
+// Usage:
+// ParallelForEach<Velocity, Acceleration>(job_system, registry,
+//     [](EntityId id, Velocity& vel, Acceleration& acc) { ... });
+//
+// Runs fn for every entity in the view, spread over the job system.
+// The registry maps are not thread safe, so the component references are all resolved up front on
+// the calling thread. fn may only touch the components it is handed, not the registry.
+template <typename... Components, typename Fn>
+void ParallelForEach(JobSystem& job_system,
+                     Registry& registry,
+                     Fn&& fn,
+                     int grain_size = kDefaultEntityGrainSize) {
+  const auto ids = registry.GetView<Components...>();
+  const auto components = ResolveComponents<Components...>(registry, ids);
+  job_system.ParallelFor(
+      0, static_cast<int>(ids.size()),
+      [&](int i) {
+        std::apply([&](Components*... ptrs) { fn(ids[i], *ptrs...); }, components[i]);
+      },
+      grain_size);
+}
+
+}  // namespace platformer
@@ -0,0 +1,254 @@
+#include "blitter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PLATFORMER_BLIT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC does not need a target attribute to use AVX2 intrinsics.
+#define PLATFORMER_TARGET_AVX2
+#else
+#define PLATFORMER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace platformer {
+
+namespace {
+
+// As olc::PixelGameEngine::Draw in the ALPHA pixel mode.
+olc::Pixel BlendAlpha(const olc::Pixel& source, const olc::Pixel& destination) {
+  const float a = source.a / 255.0f;
+  const float c = 1.0f - a;
+  return olc::Pixel(static_cast<uint8_t>(a * source.r + c * destination.r),
+                    static_cast<uint8_t>(a * source.g + c * destination.g),
+                    static_cast<uint8_t>(a * source.b + c * destination.b));
+}
+
+// Copies are memcpy in every instruction set, the standard library already vectorizes it.
+void CopyRow(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  if (count > 0) {
+    std::memcpy(destination, source, count * sizeof(olc::Pixel));
+  }
+}
+
+void CopyRowReversedScalar(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  std::reverse_copy(source, source + count, destination);
+}
+
+void BlendRowScalar(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  for (int i = 0; i < count; ++i) {
+    destination[i] = BlendAlpha(source[i], destination[i]);
+  }
+}
+
+void BlendRowReversedScalar(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  for (int i = 0; i < count; ++i) {
+    destination[i] = BlendAlpha(source[count - 1 - i], destination[i]);
+  }
+}
+
+#ifdef PLATFORMER_BLIT_X86
+
+// Blending works on one pixel per 128 bit lane, as four floats r, g, b, a, which keeps the
+// arithmetic identical to the scalar version. The alpha channel of the result is set to 255.
+
+__m128i LoadSse2(const olc::Pixel* pixels) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+void StoreSse2(olc::Pixel* pixels, const __m128i value) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+}
+
+__m128i BlendPixelSse2(const __m128i source, const __m128i destination) {
+  const __m128 source_f = _mm_cvtepi32_ps(source);
+  const __m128 a = _mm_div_ps(_mm_shuffle_ps(source_f, source_f, 0xFF), _mm_set1_ps(255.0f));
+  const __m128 c = _mm_sub_ps(_mm_set1_ps(1.0f), a);
+  return _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(a, source_f), _mm_mul_ps(c, _mm_cvtepi32_ps(destination))));
+}
+
+// Four pixels.
+__m128i BlendSse2(const __m128i source, const __m128i destination) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i source_lo = _mm_unpacklo_epi8(source, zero);
+  const __m128i source_hi = _mm_unpackhi_epi8(source, zero);
+  const __m128i destination_lo = _mm_unpacklo_epi8(destination, zero);
+  const __m128i destination_hi = _mm_unpackhi_epi8(destination, zero);
+  const __m128i p0 = BlendPixelSse2(_mm_unpacklo_epi16(source_lo, zero),
+                                    _mm_unpacklo_epi16(destination_lo, zero));
+  const __m128i p1 = BlendPixelSse2(_mm_unpackhi_epi16(source_lo, zero),
+                                    _mm_unpackhi_epi16(destination_lo, zero));
+  const __m128i p2 = BlendPixelSse2(_mm_unpacklo_epi16(source_hi, zero),
+                                    _mm_unpacklo_epi16(destination_hi, zero));
+  const __m128i p3 = BlendPixelSse2(_mm_unpackhi_epi16(source_hi, zero),
+                                    _mm_unpackhi_epi16(destination_hi, zero));
+  const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+  return _mm_or_si128(packed, _mm_set1_epi32(static_cast<int>(0xFF000000)));
+}
+
+__m128i ReverseSse2(const __m128i pixels) { return _mm_shuffle_epi32(pixels, 0x1B); }
+
+void CopyRowReversedSse2(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    StoreSse2(destination + i, ReverseSse2(LoadSse2(source + count - i - 4)));
+  }
+  CopyRowReversedScalar(source, destination + i, count - i);
+}
+
+void BlendRowSse2(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    StoreSse2(destination + i, BlendSse2(LoadSse2(source + i), LoadSse2(destination + i)));
+  }
+  BlendRowScalar(source + i, destination + i, count - i);
+}
+
+void BlendRowReversedSse2(const olc::Pixel* source, olc::Pixel* destination, const int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i source_pixels = ReverseSse2(LoadSse2(source + count - i - 4));
+    StoreSse2(destination + i, BlendSse2(source_pixels, LoadSse2(destination + i)));
+  }
+  BlendRowReversedScalar(source, destination + i, count - i);
+}
+
+// AVX2 does two pixels per register, one per 128 bit lane.
+
+PLATFORMER_TARGET_AVX2 __m256i LoadAvx2(const olc::Pixel* pixels) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels));
+}
+
+PLATFORMER_TARGET_AVX2 void StoreAvx2(olc::Pixel* pixels, const __m256i value) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), value);
+}
+
+// The two pixels in the low 8 bytes of source and destination.
+PLATFORMER_TARGET_AVX2 __m256i BlendPixelPairAvx2(const __m128i source, const __m128i destination) {
+  const __m256 source_f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(source));
+  const __m256 destination_f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(destination));
+  const __m256 a =
+      _mm256_div_ps(_mm256_shuffle_ps(source_f, source_f, 0xFF), _mm256_set1_ps(255.0f));
+  const __m256 c = _mm256_sub_ps(_mm256_set1_ps(1.0f), a);
+  return _mm256_cvttps_epi32(
+      _mm256_add_ps(_mm256_mul_ps(a, source_f), _mm256_mul_ps(c, destination_f)));
+}
+
+// Eight pixels.
+PLATFORMER_TARGET_AVX2 __m256i BlendAvx2(const __m256i source, const __m256i destination) {
+  const __m128i source_lo = _mm256_castsi256_si128(source);
+  const __m128i source_hi = _mm256_extracti128_si256(source, 1);
+  const __m128i destination_lo = _mm256_castsi256_si128(destination);
+  const __m128i destination_hi = _mm256_extracti128_si256(destination, 1);
+  const __m256i p01 = BlendPixelPairAvx2(source_lo, destination_lo);
+  const __m256i p23 =
+      BlendPixelPairAvx2(_mm_srli_si128(source_lo, 8), _mm_srli_si128(destination_lo, 8));
+  const __m256i p45 = BlendPixelPairAvx2(source_hi, destination_hi);
+  const __m256i p67 =
+      BlendPixelPairAvx2(_mm_srli_si128(source_hi, 8), _mm_srli_si128(destination_hi, 8));
+  // Packing works per 128 bit lane and leaves the pixels in the order 0 2 4 6 1 3 5 7.
+  const __m256i packed =
+      _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+  const __m256i ordered =
+      _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+  return _mm256_or_si256(ordered, _mm256_set1_epi32(static_cast<int>(0xFF000000)));
+}
+
+PLATFORMER_TARGET_AVX2 __m256i ReverseAvx2(const __m256i pixels) {
+  return _mm256_permutevar8x32_epi32(pixels, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+PLATFORMER_TARGET_AVX2 void CopyRowReversedAvx2(const olc::Pixel* source,
+                                                olc::Pixel* destination,
+                                                const int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    StoreAvx2(destination + i, ReverseAvx2(LoadAvx2(source + count - i - 8)));
+  }
+  CopyRowReversedScalar(source, destination + i, count - i);
+}
+
+PLATFORMER_TARGET_AVX2 void BlendRowAvx2(const olc::Pixel* source,
+                                         olc::Pixel* destination,
+                                         const int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    StoreAvx2(destination + i, BlendAvx2(LoadAvx2(source + i), LoadAvx2(destination + i)));
+  }
+  BlendRowScalar(source + i, destination + i, count - i);
+}
+
+PLATFORMER_TARGET_AVX2 void BlendRowReversedAvx2(const olc::Pixel* source,
+                                                 olc::Pixel* destination,
+                                                 const int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i source_pixels = ReverseAvx2(LoadAvx2(source + count - i - 8));
+    StoreAvx2(destination + i, BlendAvx2(source_pixels, LoadAvx2(destination + i)));
+  }
+  BlendRowReversedScalar(source, destination + i, count - i);
+}
+
+bool CpuSupportsAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+  if (!has_osxsave || (_xgetbv(0) & 6) != 6) {
+    return false;  // The OS does not save the AVX registers.
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // PLATFORMER_BLIT_X86
+
+const BlitKernels kScalarKernels{CopyRow, CopyRowReversedScalar, BlendRowScalar,
+                                 BlendRowReversedScalar};
+#ifdef PLATFORMER_BLIT_X86
+const BlitKernels kSse2Kernels{CopyRow, CopyRowReversedSse2, BlendRowSse2, BlendRowReversedSse2};
+const BlitKernels kAvx2Kernels{CopyRow, CopyRowReversedAvx2, BlendRowAvx2, BlendRowReversedAvx2};
+#endif
+
+}  // namespace
+
+const BlitKernels* GetBlitKernels(const BlitInstructionSet instruction_set) {
+  switch (instruction_set) {
+    case BlitInstructionSet::kScalar:
+      return &kScalarKernels;
+#ifdef PLATFORMER_BLIT_X86
+    case BlitInstructionSet::kSse2:
+      return &kSse2Kernels;  // Part of x86-64.
+    case BlitInstructionSet::kAvx2:
+      return CpuSupportsAvx2() ? &kAvx2Kernels : nullptr;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+const BlitKernels& GetBestBlitKernels() {
+  static const BlitKernels& best = []() -> const BlitKernels& {
+    for (const auto instruction_set : {BlitInstructionSet::kAvx2, BlitInstructionSet::kSse2}) {
+      if (const auto* kernels = GetBlitKernels(instruction_set)) {
+        return *kernels;
+      }
+    }
+    return kScalarKernels;
+  }();
+  return best;
+}
+
+}  // namespace platformer
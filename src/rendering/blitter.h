@@ -0,0 +1,28 @@
+#pragma once
+
+#include "olcPixelGameEngine.h"
+
+namespace platformer {
+
+// Row kernels for drawing pixels into a draw target. Each writes `count` pixels to destination,
+// which must not overlap the source.
+//
+// The blend kernels give the same result as olc::PixelGameEngine::Draw in the ALPHA pixel mode,
+// bit for bit: the SIMD versions do the same float operations, in the same order, as the engine.
+struct BlitKernels {
+  void (*copy)(const olc::Pixel* source, olc::Pixel* destination, int count);
+  // destination[i] = source[count - 1 - i], for horizontally flipped sprites.
+  void (*copy_reversed)(const olc::Pixel* source, olc::Pixel* destination, int count);
+  void (*blend)(const olc::Pixel* source, olc::Pixel* destination, int count);
+  void (*blend_reversed)(const olc::Pixel* source, olc::Pixel* destination, int count);
+};
+
+enum class BlitInstructionSet { kScalar, kSse2, kAvx2 };
+
+// Nullptr if this build or the CPU does not support the instruction set.
+[[nodiscard]] const BlitKernels* GetBlitKernels(BlitInstructionSet instruction_set);
+
+// The fastest kernels the CPU supports, picked on first use.
+[[nodiscard]] const BlitKernels& GetBestBlitKernels();
+
+}  // namespace platformer
@@ -0,0 +1,297 @@
+#include "draw_command_list.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+void SetPixel(const int x,
+              const int y,
+              const olc::Pixel color,
+              olc::Sprite& target,
+              const RowRange rows) {
+  if (x >= 0 && x < target.width && y >= rows.begin && y < rows.end) {
+    target.GetData()[y * target.width + x] = color;
+  }
+}
+
+}  // namespace
+
+void DrawCommandList::Fill(const olc::Pixel color) { commands_.emplace_back(FillCommand{color}); }
+
+void DrawCommandList::DrawSpans(const olc::Pixel* pixels,
+                                const SpriteSpans& spans,
+                                const int x,
+                                const int y,
+                                const olc::Sprite::Flip flip) {
+  commands_.emplace_back(SpansCommand{pixels, &spans, x, y, flip});
+}
+
+void DrawCommandList::CopyImageRepeated(const olc::Sprite& image,
+                                        const int x,
+                                        const int y,
+                                        const int num_x,
+                                        const int num_y) {
+  commands_.emplace_back(RepeatedImageCommand{&image, x, y, num_x, num_y});
+}
+
+void DrawCommandList::DrawPrimitive(const int x,
+                                    const int y,
+                                    const olc::Pixel color,
+                                    const PrimitiveShape shape) {
+  const Primitive primitive{x, y, color, shape};
+  AddToBatch<PrimitivesCommand>(primitives_, &primitive, &primitive + 1);
+}
+
+void DrawCommandList::DrawPrimitives(const Primitive* primitives, const int num_primitives) {
+  AddToBatch<PrimitivesCommand>(primitives_, primitives, primitives + num_primitives);
+}
+
+void DrawCommandList::DrawLine(const int x0,
+                               const int y0,
+                               const int x1,
+                               const int y1,
+                               const olc::Pixel color) {
+  const Line line{x0, y0, x1, y1, color};
+  AddToBatch<LinesCommand>(lines_, &line, &line + 1);
+}
+
+void DrawCommandList::FillRect(const int x,
+                               const int y,
+                               const int width,
+                               const int height,
+                               const olc::Pixel color) {
+  const Rect rect{x, y, width, height, color};
+  AddToBatch<RectsCommand>(rects_, &rect, &rect + 1);
+}
+
+template <typename BatchCommand, typename T>
+void DrawCommandList::AddToBatch(std::vector<T>& elements, const T* first, const T* last) {
+  if (first == last) {
+    return;
+  }
+  const int begin = static_cast<int>(elements.size());
+  elements.insert(elements.end(), first, last);
+  const int end = static_cast<int>(elements.size());
+  if (!commands_.empty()) {
+    if (auto* batch = std::get_if<BatchCommand>(&commands_.back())) {
+      batch->end = end;
+      return;
+    }
+  }
+  commands_.emplace_back(BatchCommand{begin, end});
+}
+
+void DrawCommandList::RunSerial(std::function<void()> fn) {
+  commands_.emplace_back(SerialCommand{std::move(fn)});
+}
+
+void DrawCommandList::Clear() {
+  commands_.clear();
+  primitives_.clear();
+  lines_.clear();
+  rects_.clear();
+}
+
+void DrawCommandList::Replay(olc::Sprite& target) const {
+  Rasterize(target, 1, nullptr);
+}
+
+void DrawCommandList::Replay(olc::Sprite& target, const RowRange rows) const {
+  RB_CHECK(!HasSerialCommands());
+  ReplayRows(target, RowRange{std::max(rows.begin, 0), std::min(rows.end, target.height)}, 0,
+             commands_.size());
+}
+
+bool DrawCommandList::HasSerialCommands() const {
+  return std::any_of(commands_.begin(), commands_.end(), [](const Command& command) {
+    return std::holds_alternative<SerialCommand>(command);
+  });
+}
+
+void DrawCommandList::ReplayBanded(olc::Sprite& target,
+                                   const int num_bands,
+                                   JobSystem& job_system) const {
+  Rasterize(target, num_bands, &job_system);
+}
+
+void DrawCommandList::Rasterize(olc::Sprite& target,
+                                const int num_bands,
+                                JobSystem* job_system) const {
+  RB_CHECK(num_bands > 0);
+  const int band_height = (target.height + num_bands - 1) / num_bands;
+  const auto is_serial = [](const Command& command) {
+    return std::holds_alternative<SerialCommand>(command);
+  };
+
+  size_t begin = 0;
+  while (begin < commands_.size()) {
+    // Rasterize everything up to the next serial command band by band, then run the serial ones.
+    const auto end = static_cast<size_t>(
+        std::find_if(commands_.begin() + begin, commands_.end(), is_serial) - commands_.begin());
+    if (begin < end) {
+      if (job_system == nullptr) {
+        ReplayRows(target, RowRange{0, target.height}, begin, end);
+      } else {
+        job_system->ParallelFor(0, num_bands, [&](const int band) {
+          const RowRange rows{band * band_height,
+                              std::min(target.height, (band + 1) * band_height)};
+          ReplayRows(target, rows, begin, end);
+        });
+      }
+    }
+    for (begin = end; begin < commands_.size() && is_serial(commands_[begin]); ++begin) {
+      std::get<SerialCommand>(commands_[begin]).fn();
+    }
+  }
+}
+
+void DrawCommandList::CopyImageRows(const RepeatedImageCommand& command,
+                                    olc::Sprite& target,
+                                    const RowRange rows) {
+  const olc::Sprite& image = *command.image;
+  const int min_x = std::max(command.x, 0);
+  const int max_x = std::min(command.x + command.num_x * image.width, target.width);
+  const int min_y = std::max(command.y, rows.begin);
+  const int max_y = std::min(command.y + command.num_y * image.height, rows.end);
+  if (min_x >= max_x) {
+    return;
+  }
+  for (int y = min_y; y < max_y; ++y) {
+    // The copies wrap around the image, so each row is at most a few memcpys.
+    const olc::Pixel* source_row =
+        image.pColData.data() + (y - command.y) % image.height * image.width;
+    olc::Pixel* destination = target.GetData() + y * target.width + min_x;
+    int source_x = (min_x - command.x) % image.width;
+    int remaining = max_x - min_x;
+    while (remaining > 0) {
+      const int length = std::min(remaining, image.width - source_x);
+      std::memcpy(destination, source_row + source_x, length * sizeof(olc::Pixel));
+      destination += length;
+      remaining -= length;
+      source_x = 0;
+    }
+  }
+}
+
+void DrawCommandList::DrawLineRows(const Line& line, olc::Sprite& target, const RowRange rows) {
+  // The same steps as olc::PixelGameEngine::DrawLine, so the same pixels are set.
+  int x0 = line.x0;
+  int y0 = line.y0;
+  int x1 = line.x1;
+  int y1 = line.y1;
+  const int dx = x1 - x0;
+  const int dy = y1 - y0;
+  if (dx == 0) {
+    if (y1 < y0) {
+      std::swap(y0, y1);
+    }
+    for (int y = std::max(y0, rows.begin); y <= std::min(y1, rows.end - 1); ++y) {
+      SetPixel(x0, y, line.color, target, rows);
+    }
+    return;
+  }
+  if (dy == 0) {
+    if (y0 < rows.begin || y0 >= rows.end) {
+      return;
+    }
+    if (x1 < x0) {
+      std::swap(x0, x1);
+    }
+    for (int x = std::max(x0, 0); x <= std::min(x1, target.width - 1); ++x) {
+      SetPixel(x, y0, line.color, target, rows);
+    }
+    return;
+  }
+
+  const int dx1 = std::abs(dx);
+  const int dy1 = std::abs(dy);
+  const int y_step = (dx < 0) == (dy < 0) ? 1 : -1;
+  int px = 2 * dy1 - dx1;
+  int py = 2 * dx1 - dy1;
+  if (dy1 <= dx1) {
+    int x = dx >= 0 ? x0 : x1;
+    int y = dx >= 0 ? y0 : y1;
+    const int x_end = dx >= 0 ? x1 : x0;
+    SetPixel(x, y, line.color, target, rows);
+    while (x < x_end) {
+      ++x;
+      if (px < 0) {
+        px += 2 * dy1;
+      } else {
+        y += y_step;
+        px += 2 * (dy1 - dx1);
+      }
+      SetPixel(x, y, line.color, target, rows);
+    }
+  } else {
+    int x = dy >= 0 ? x0 : x1;
+    int y = dy >= 0 ? y0 : y1;
+    const int y_end = dy >= 0 ? y1 : y0;
+    SetPixel(x, y, line.color, target, rows);
+    while (y < y_end) {
+      ++y;
+      if (py <= 0) {
+        py += 2 * dx1;
+      } else {
+        x += y_step;
+        py += 2 * (dx1 - dy1);
+      }
+      SetPixel(x, y, line.color, target, rows);
+    }
+  }
+}
+
+void DrawCommandList::ReplayRows(olc::Sprite& target,
+                                 const RowRange rows,
+                                 const size_t begin,
+                                 const size_t end) const {
+  if (rows.begin >= rows.end) {
+    return;
+  }
+  olc::Pixel* pixels = target.GetData();
+  for (size_t i = begin; i < end; ++i) {
+    const Command& command = commands_[i];
+    if (const auto* fill = std::get_if<FillCommand>(&command)) {
+      std::fill(pixels + rows.begin * target.width, pixels + rows.end * target.width, fill->color);
+    } else if (const auto* spans = std::get_if<SpansCommand>(&command)) {
+      platformer::DrawSpans(spans->pixels, *spans->spans, spans->x, spans->y, spans->flip, target,
+                            rows);
+    } else if (const auto* repeated = std::get_if<RepeatedImageCommand>(&command)) {
+      CopyImageRows(*repeated, target, rows);
+    } else if (const auto* batch = std::get_if<PrimitivesCommand>(&command)) {
+      // The free function, not the member that records primitives.
+      platformer::DrawPrimitives(primitives_.data() + batch->begin, batch->end - batch->begin,
+                                 target, rows);
+    } else if (const auto* lines = std::get_if<LinesCommand>(&command)) {
+      for (int j = lines->begin; j < lines->end; ++j) {
+        DrawLineRows(lines_[j], target, rows);
+      }
+    } else if (const auto* rects = std::get_if<RectsCommand>(&command)) {
+      for (int j = rects->begin; j < rects->end; ++j) {
+        const Rect& rect = rects_[j];
+        const int min_x = std::max(rect.x, 0);
+        const int max_x = std::min(rect.x + rect.width, target.width);
+        if (min_x >= max_x) {
+          continue;
+        }
+        const int min_y = std::max(rect.y, rows.begin);
+        const int max_y = std::min(rect.y + rect.height, rows.end);
+        for (int y = min_y; y < max_y; ++y) {
+          std::fill(pixels + y * target.width + min_x, pixels + y * target.width + max_x,
+                    rect.color);
+        }
+      }
+    } else {
+      RB_CHECK(false);  // Serial commands are run by Rasterize.
+    }
+  }
+}
+
+}  // namespace platformer
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <functional>
+#include <variant>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/primitive_batch.h"
+#include "rendering/sprite_spans.h"
+#include "utils/job_system.h"
+
+namespace platformer {
+
+// The draw commands of a frame, recorded so they can be rasterized later, possibly in parallel.
+//
+// Apart from the serial commands, every command only writes to the rows it covers and the
+// commands are applied in order within each row. So rasterizing the frame in horizontal bands,
+// each band replaying the whole list clipped to its rows, gives the same pixels as replaying the
+// list in one go.
+class DrawCommandList {
+ public:
+  // Overwrites every pixel of the target.
+  void Fill(olc::Pixel color);
+
+  // As the DrawSpans function. The pixels and spans are not copied, they must outlive the replay.
+  void DrawSpans(const olc::Pixel* pixels,
+                 const SpriteSpans& spans,
+                 int x,
+                 int y,
+                 olc::Sprite::Flip flip);
+
+  // Overwrites the target with num_x by num_y copies of the image side by side, the first one with
+  // its top left corner at (x, y). The image is copied row by row, not blended, so it should be
+  // opaque. It is not copied into the list, it must outlive the replay.
+  void CopyImageRepeated(const olc::Sprite& image, int x, int y, int num_x, int num_y);
+
+  // Overwrites the pixels of the shape centred on (x, y) that are on the target.
+  void DrawPrimitive(int x, int y, olc::Pixel color, PrimitiveShape shape);
+  // As DrawPrimitive for each of the primitives, in order. They are copied into the list.
+  void DrawPrimitives(const Primitive* primitives, int num_primitives);
+  // Overwrites a single pixel, if it is on the target.
+  void DrawPoint(int x, int y, olc::Pixel color) {
+    DrawPrimitive(x, y, color, PrimitiveShape::kPoint);
+  }
+
+  // Overwrites the pixels of the line from (x0, y0) to (x1, y1), both ends included. For an opaque
+  // color and a line on the target, the result is the same as olc::PixelGameEngine::DrawLine.
+  void DrawLine(int x0, int y0, int x1, int y1, olc::Pixel color);
+
+  // Overwrites the pixels of the rectangle with its top left corner at (x, y).
+  void FillRect(int x, int y, int width, int height, olc::Pixel color);
+
+  // Anything the list cannot clip, e.g. drawing through the engine. A banded replay runs these on
+  // the calling thread, once everything recorded before them has been rasterized.
+  void RunSerial(std::function<void()> fn);
+
+  void Clear();
+  [[nodiscard]] int GetNumCommands() const { return static_cast<int>(commands_.size()); }
+
+  // Rasterizes all commands onto the target, on the calling thread.
+  void Replay(olc::Sprite& target) const;
+
+  // As Replay, but only rasterizes the rows of the target within rows. The list must not hold
+  // serial commands, as they cannot be clipped.
+  void Replay(olc::Sprite& target, RowRange rows) const;
+
+  // As Replay, but splits the target into num_bands horizontal bands that are rasterized in
+  // parallel.
+  void ReplayBanded(olc::Sprite& target, int num_bands, JobSystem& job_system) const;
+
+ private:
+  struct FillCommand {
+    olc::Pixel color;
+  };
+  struct SpansCommand {
+    const olc::Pixel* pixels;
+    const SpriteSpans* spans;
+    int x;
+    int y;
+    olc::Sprite::Flip flip;
+  };
+  struct RepeatedImageCommand {
+    const olc::Sprite* image;
+    int x;
+    int y;
+    int num_x;
+    int num_y;
+  };
+  // Consecutive primitives, lines and rectangles are batched into one command each, which covers
+  // [begin, end) of primitives_, lines_ or rects_.
+  struct PrimitivesCommand {
+    int begin;
+    int end;
+  };
+  struct LinesCommand {
+    int begin;
+    int end;
+  };
+  struct RectsCommand {
+    int begin;
+    int end;
+  };
+  struct SerialCommand {
+    std::function<void()> fn;
+  };
+  struct Line {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    olc::Pixel color;
+  };
+  struct Rect {
+    int x;
+    int y;
+    int width;
+    int height;
+    olc::Pixel color;
+  };
+  using Command = std::variant<FillCommand,
+                               SpansCommand,
+                               RepeatedImageCommand,
+                               PrimitivesCommand,
+                               LinesCommand,
+                               RectsCommand,
+                               SerialCommand>;
+
+  // Appends elements [first, last) to a batch, extending the last command if it is a batch of the
+  // same type.
+  template <typename BatchCommand, typename T>
+  void AddToBatch(std::vector<T>& elements, const T* first, const T* last);
+
+  [[nodiscard]] bool HasSerialCommands() const;
+  // Runs the commands, with the bands in parallel if there is a job system.
+  void Rasterize(olc::Sprite& target, int num_bands, JobSystem* job_system) const;
+  static void CopyImageRows(const RepeatedImageCommand& command,
+                            olc::Sprite& target,
+                            RowRange rows);
+  static void DrawLineRows(const Line& line, olc::Sprite& target, RowRange rows);
+  // Rasterizes commands [begin, end), which must not be serial, clipped to the rows.
+  void ReplayRows(olc::Sprite& target, RowRange rows, size_t begin, size_t end) const;
+
+  std::vector<Command> commands_;
+  std::vector<Primitive> primitives_;
+  std::vector<Line> lines_;
+  std::vector<Rect> rects_;
+};
+
+}  // namespace platformer
@@ -0,0 +1,66 @@
+#include "primitive_batch.h"
+
+#include <algorithm>
+
+namespace platformer {
+
+namespace {
+
+void SetPixelClipped(const int x,
+                     const int y,
+                     const olc::Pixel color,
+                     olc::Pixel* pixels,
+                     const int width,
+                     const RowRange rows) {
+  if (x >= 0 && x < width && y >= rows.begin && y < rows.end) {
+    pixels[y * width + x] = color;
+  }
+}
+
+}  // namespace
+
+void DrawPrimitives(const Primitive* primitives,
+                    const int num_primitives,
+                    olc::Sprite& target,
+                    const RowRange clip_rows) {
+  const int width = target.width;
+  const RowRange rows{std::max(clip_rows.begin, 0), std::min(clip_rows.end, target.height)};
+  if (rows.begin >= rows.end) {
+    return;
+  }
+  olc::Pixel* pixels = target.GetData();
+
+  for (int i = 0; i < num_primitives; ++i) {
+    const Primitive& primitive = primitives[i];
+    const int radius = GetPrimitiveRadius(primitive.shape);
+    const int x = primitive.x;
+    const int y = primitive.y;
+    if (x - radius >= 0 && x + radius < width && y - radius >= rows.begin &&
+        y + radius < rows.end) {
+      olc::Pixel* center = pixels + y * width + x;
+      *center = primitive.color;
+      if (primitive.shape == PrimitiveShape::kPlus) {
+        center[-1] = primitive.color;
+        center[1] = primitive.color;
+        center[-width] = primitive.color;
+        center[width] = primitive.color;
+      }
+      continue;
+    }
+    if (x + radius < 0 || x - radius >= width || y + radius < rows.begin ||
+        y - radius >= rows.end) {
+      continue;
+    }
+
+    // On the border of the target or the rows.
+    SetPixelClipped(x, y, primitive.color, pixels, width, rows);
+    if (primitive.shape == PrimitiveShape::kPlus) {
+      SetPixelClipped(x - 1, y, primitive.color, pixels, width, rows);
+      SetPixelClipped(x + 1, y, primitive.color, pixels, width, rows);
+      SetPixelClipped(x, y - 1, primitive.color, pixels, width, rows);
+      SetPixelClipped(x, y + 1, primitive.color, pixels, width, rows);
+    }
+  }
+}
+
+}  // namespace platformer
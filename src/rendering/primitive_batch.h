@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common_types/components.h"
+#include "olcPixelGameEngine.h"
+#include "rendering/sprite_spans.h"
+
+namespace platformer {
+
+// A small opaque shape centred on the pixel (x, y).
+struct Primitive {
+  int x;
+  int y;
+  olc::Pixel color;
+  PrimitiveShape shape;
+};
+
+inline olc::Pixel ToPixel(const Rgba& color) {
+  return olc::Pixel(color.r, color.g, color.b, color.a);
+}
+
+// How far the shape reaches from its centre, in pixels.
+inline int GetPrimitiveRadius(const PrimitiveShape shape) {
+  return shape == PrimitiveShape::kPlus ? 1 : 0;
+}
+
+// Overwrites the pixels of the primitives that are on the target and within the rows, in order.
+// Each primitive is clipped once: the ones entirely inside are written without any further
+// checks.
+void DrawPrimitives(const Primitive* primitives,
+                    int num_primitives,
+                    olc::Sprite& target,
+                    RowRange clip_rows);
+
+}  // namespace platformer
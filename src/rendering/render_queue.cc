@@ -0,0 +1,345 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+// Sorts the ranges and merges the ones that overlap or touch.
+void MergeRows(std::vector<RowRange>& rows) {
+  rows.erase(std::remove_if(rows.begin(), rows.end(),
+                            [](const RowRange& range) { return range.begin >= range.end; }),
+             rows.end());
+  std::sort(rows.begin(), rows.end(),
+            [](const RowRange& lhs, const RowRange& rhs) { return lhs.begin < rhs.begin; });
+  size_t num_merged = 0;
+  for (const auto& range : rows) {
+    if (num_merged > 0 && range.begin <= rows[num_merged - 1].end) {
+      rows[num_merged - 1].end = std::max(rows[num_merged - 1].end, range.end);
+    } else {
+      rows[num_merged++] = range;
+    }
+  }
+  rows.resize(num_merged);
+}
+
+// Marks the values in one of the longest strictly increasing subsequences.
+std::vector<bool> FindLongestIncreasingSubsequence(const std::vector<int>& values) {
+  // The index of the smallest last value of the increasing subsequences of each length so far.
+  std::vector<int> tails;
+  std::vector<int> predecessors(values.size(), -1);
+  for (int i = 0; i < static_cast<int>(values.size()); ++i) {
+    const auto tail = std::lower_bound(
+        tails.begin(), tails.end(), values[i],
+        [&values](const int index, const int value) { return values[index] < value; });
+    if (tail != tails.begin()) {
+      predecessors[i] = *(tail - 1);
+    }
+    if (tail == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *tail = i;
+    }
+  }
+  std::vector<bool> in_subsequence(values.size(), false);
+  for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = predecessors[i]) {
+    in_subsequence[i] = true;
+  }
+  return in_subsequence;
+}
+
+}  // namespace
+
+void RenderQueue::SubmitSprite(const RenderLayer layer,
+                               const int sort_key,
+                               const olc::Pixel* pixels,
+                               const SpriteSpans& spans,
+                               const int x,
+                               const int y,
+                               const olc::Sprite::Flip flip) {
+  Submit(layer, sort_key, pixels, Kind::kSprite, static_cast<int>(sprites_.size()));
+  sprites_.push_back(SpriteDraw{pixels, &spans, x, y, flip});
+}
+
+void RenderQueue::SubmitRepeatedImage(const RenderLayer layer,
+                                      const int sort_key,
+                                      const olc::Sprite& image,
+                                      const int x,
+                                      const int y,
+                                      const int num_x,
+                                      const int num_y) {
+  Submit(layer, sort_key, &image, Kind::kRepeatedImage,
+         static_cast<int>(repeated_images_.size()));
+  repeated_images_.push_back(RepeatedImageDraw{&image, x, y, num_x, num_y});
+}
+
+void RenderQueue::SubmitPrimitive(const RenderLayer layer,
+                                  const int sort_key,
+                                  const int x,
+                                  const int y,
+                                  const olc::Pixel color,
+                                  const PrimitiveShape shape) {
+  Submit(layer, sort_key, &primitives_, Kind::kPrimitive, static_cast<int>(primitives_.size()));
+  primitives_.push_back(Primitive{x, y, color, shape});
+}
+
+void RenderQueue::SubmitPrimitives(const RenderLayer layer,
+                                   const int sort_key,
+                                   const Primitive* primitives,
+                                   const int num_primitives) {
+  if (num_primitives <= 0) {
+    return;
+  }
+  // Same source as single primitives, so both keep their submission order.
+  Submit(layer, sort_key, &primitives_, Kind::kPrimitives,
+         static_cast<int>(primitive_batches_.size()));
+  primitive_batches_.push_back(PrimitivesDraw{primitives, num_primitives});
+}
+
+void RenderQueue::SubmitLine(const RenderLayer layer,
+                             const int sort_key,
+                             const int x0,
+                             const int y0,
+                             const int x1,
+                             const int y1,
+                             const olc::Pixel color) {
+  Submit(layer, sort_key, &lines_, Kind::kLine, static_cast<int>(lines_.size()));
+  lines_.push_back(LineDraw{x0, y0, x1, y1, color});
+}
+
+void RenderQueue::SubmitRect(const RenderLayer layer,
+                             const int sort_key,
+                             const int x,
+                             const int y,
+                             const int width,
+                             const int height,
+                             const olc::Pixel color) {
+  Submit(layer, sort_key, &rects_, Kind::kRect, static_cast<int>(rects_.size()));
+  rects_.push_back(RectDraw{x, y, width, height, color});
+}
+
+void RenderQueue::SubmitCallback(const RenderLayer layer,
+                                 const int sort_key,
+                                 std::function<void()> fn) {
+  Submit(layer, sort_key, &callbacks_, Kind::kCallback, static_cast<int>(callbacks_.size()));
+  callbacks_.push_back(std::move(fn));
+}
+
+void RenderQueue::Submit(const RenderLayer layer,
+                         const int sort_key,
+                         const void* source,
+                         const Kind kind,
+                         const int index) {
+  if (source != last_source_ || batches_.empty()) {
+    last_batch_ = batches_.emplace(source, static_cast<int>(batches_.size())).first->second;
+    last_source_ = source;
+  }
+  items_.push_back(Item{layer, sort_key, last_batch_, kind, index});
+}
+
+void RenderQueue::Flush(DrawCommandList& commands) {
+  SortItems();
+  AppendCommands(commands);
+  has_previous_frame_ = false;
+  Clear();
+}
+
+bool RenderQueue::FlushDamage(DrawCommandList& commands, std::vector<RowRange>& damaged_rows) {
+  SortItems();
+  std::vector<DrawRecord> records;  // In draw order.
+  records.reserve(items_.size());
+  for (const auto& item : items_) {
+    if (item.kind != Kind::kCallback) {
+      AppendRecords(item, records);
+    }
+  }
+  const auto key = [](const DrawRecord& record) {
+    return std::tie(record.layer, record.sort_key, record.kind, record.source, record.values);
+  };
+  const auto less = [&key](const DrawRecord& lhs, const DrawRecord& rhs) {
+    return key(lhs) < key(rhs);
+  };
+  const auto sort_by_key = [&less](const std::vector<DrawRecord>& frame) {
+    std::vector<int> order(frame.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const int lhs, const int rhs) { return less(frame[lhs], frame[rhs]); });
+    return order;
+  };
+  const auto previous_order = sort_by_key(previous_records_);
+  const auto current_order = sort_by_key(records);
+
+  // The draws in only one of the frames. Equal draws are paired up in draw order.
+  damaged_rows.clear();
+  std::vector<int> previous_indices(records.size(), -1);  // Of the same draw, if any.
+  auto previous = previous_order.begin();
+  auto current = current_order.begin();
+  while (previous != previous_order.end() || current != current_order.end()) {
+    if (current == current_order.end() ||
+        (previous != previous_order.end() &&
+         less(previous_records_[*previous], records[*current]))) {
+      damaged_rows.push_back(previous_records_[*(previous++)].rows);
+    } else if (previous == previous_order.end() ||
+               less(records[*current], previous_records_[*previous])) {
+      damaged_rows.push_back(records[*(current++)].rows);
+    } else {
+      previous_indices[*(current++)] = *(previous++);
+    }
+  }
+
+  // The draws in both frames that changed places with each other, e.g. when the batches of a sort
+  // key were reordered. The most draws that kept their order are left out.
+  std::vector<int> matched_indices;
+  std::vector<int> matched_previous_indices;
+  for (int i = 0; i < static_cast<int>(records.size()); ++i) {
+    if (previous_indices[i] >= 0) {
+      matched_indices.push_back(i);
+      matched_previous_indices.push_back(previous_indices[i]);
+    }
+  }
+  const auto in_order = FindLongestIncreasingSubsequence(matched_previous_indices);
+  for (size_t i = 0; i < matched_indices.size(); ++i) {
+    if (!in_order[i]) {
+      damaged_rows.push_back(records[matched_indices[i]].rows);
+    }
+  }
+  MergeRows(damaged_rows);
+
+  const bool damage_known = has_previous_frame_ && callbacks_.empty();
+  has_previous_frame_ = callbacks_.empty();
+  previous_records_ = std::move(records);
+  AppendCommands(commands);
+  Clear();
+  return damage_known;
+}
+
+void RenderQueue::AppendRecords(const Item& item, std::vector<DrawRecord>& records) const {
+  const auto primitive_record = [&item](const Primitive& primitive) {
+    const int radius = GetPrimitiveRadius(primitive.shape);
+    return DrawRecord{item.layer,
+                      item.sort_key,
+                      Kind::kPrimitive,
+                      nullptr,
+                      {primitive.x, primitive.y, static_cast<int>(primitive.color.n),
+                       static_cast<int>(primitive.shape)},
+                      RowRange{primitive.y - radius, primitive.y + radius + 1}};
+  };
+  DrawRecord record{item.layer, item.sort_key, item.kind, nullptr, {}, {}};
+  switch (item.kind) {
+    case Kind::kSprite: {
+      const auto& sprite = sprites_[item.index];
+      record.source = sprite.pixels;
+      record.values = {sprite.x, sprite.y, static_cast<int>(sprite.flip)};
+      record.rows = RowRange{sprite.y, sprite.y + sprite.spans->GetHeight()};
+      break;
+    }
+    case Kind::kRepeatedImage: {
+      const auto& repeated = repeated_images_[item.index];
+      record.source = repeated.image;
+      record.values = {repeated.x, repeated.y, repeated.num_x, repeated.num_y};
+      record.rows =
+          RowRange{repeated.y, repeated.y + repeated.num_y * repeated.image->height};
+      break;
+    }
+    case Kind::kPrimitive:
+      records.push_back(primitive_record(primitives_[item.index]));
+      return;
+    case Kind::kPrimitives: {
+      const auto& batch = primitive_batches_[item.index];
+      for (int i = 0; i < batch.num_primitives; ++i) {
+        records.push_back(primitive_record(batch.primitives[i]));
+      }
+      return;
+    }
+    case Kind::kLine: {
+      const auto& line = lines_[item.index];
+      record.values = {line.x0, line.y0, line.x1, line.y1, static_cast<int>(line.color.n)};
+      record.rows = RowRange{std::min(line.y0, line.y1), std::max(line.y0, line.y1) + 1};
+      break;
+    }
+    case Kind::kRect: {
+      const auto& rect = rects_[item.index];
+      record.values = {rect.x, rect.y, rect.width, rect.height, static_cast<int>(rect.color.n)};
+      record.rows = RowRange{rect.y, rect.y + rect.height};
+      break;
+    }
+    case Kind::kCallback:
+      RB_CHECK(false);  // Callbacks cannot be compared.
+      break;
+  }
+  records.push_back(record);
+}
+
+void RenderQueue::SortItems() {
+  // Stable, to keep the submission order within a batch.
+  std::stable_sort(items_.begin(), items_.end(), [](const Item& lhs, const Item& rhs) {
+    if (lhs.layer != rhs.layer) {
+      return lhs.layer < rhs.layer;
+    }
+    if (lhs.sort_key != rhs.sort_key) {
+      return lhs.sort_key < rhs.sort_key;
+    }
+    return lhs.batch < rhs.batch;
+  });
+}
+
+void RenderQueue::AppendCommands(DrawCommandList& commands) {
+  for (const auto& item : items_) {
+    switch (item.kind) {
+      case Kind::kSprite: {
+        const auto& sprite = sprites_[item.index];
+        commands.DrawSpans(sprite.pixels, *sprite.spans, sprite.x, sprite.y, sprite.flip);
+        break;
+      }
+      case Kind::kRepeatedImage: {
+        const auto& repeated = repeated_images_[item.index];
+        commands.CopyImageRepeated(*repeated.image, repeated.x, repeated.y, repeated.num_x,
+                                   repeated.num_y);
+        break;
+      }
+      case Kind::kPrimitive: {
+        const auto& primitive = primitives_[item.index];
+        commands.DrawPrimitive(primitive.x, primitive.y, primitive.color, primitive.shape);
+        break;
+      }
+      case Kind::kPrimitives: {
+        const auto& batch = primitive_batches_[item.index];
+        commands.DrawPrimitives(batch.primitives, batch.num_primitives);
+        break;
+      }
+      case Kind::kLine: {
+        const auto& line = lines_[item.index];
+        commands.DrawLine(line.x0, line.y0, line.x1, line.y1, line.color);
+        break;
+      }
+      case Kind::kRect: {
+        const auto& rect = rects_[item.index];
+        commands.FillRect(rect.x, rect.y, rect.width, rect.height, rect.color);
+        break;
+      }
+      case Kind::kCallback:
+        commands.RunSerial(std::move(callbacks_[item.index]));
+        break;
+    }
+  }
+}
+
+void RenderQueue::Clear() {
+  items_.clear();
+  batches_.clear();
+  sprites_.clear();
+  repeated_images_.clear();
+  primitives_.clear();
+  primitive_batches_.clear();
+  lines_.clear();
+  rects_.clear();
+  callbacks_.clear();
+}
+
+}  // namespace platformer
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/primitive_batch.h"
+#include "rendering/sprite_spans.h"
+
+namespace platformer {
+
+// Layers are drawn back to front, in the order they are declared.
+enum class RenderLayer : uint8_t {
+  kBackground,
+  kTiles,
+  kEntities,
+  kDebug,
+  kEffects,
+  kForeground,
+};
+
+// Collects the draws of a frame from whoever traverses the scene, then orders them for the
+// rasterizer.
+//
+// Submissions are sorted by layer, then by sort key, then batched by source: all sprites drawn
+// from the same image, and all primitives, lines and rectangles, are drawn together, in the order
+// each source was first submitted. Within a batch, submission order is kept.
+//
+// The sort key orders the draws within a layer, higher keys on top. Only draws with equal keys are
+// reordered into batches, so give draws whose stacking matters different keys that do not change
+// from frame to frame. E.g. entities use their id, the static layers 0.
+//
+// The queue does not copy images or spans, they must outlive the draw commands it is flushed to.
+class RenderQueue {
+ public:
+  void SubmitSprite(RenderLayer layer,
+                    int sort_key,
+                    const olc::Pixel* pixels,
+                    const SpriteSpans& spans,
+                    int x,
+                    int y,
+                    olc::Sprite::Flip flip);
+  // Opaque image repeated num_x by num_y times, see DrawCommandList::CopyImageRepeated.
+  void SubmitRepeatedImage(RenderLayer layer,
+                           int sort_key,
+                           const olc::Sprite& image,
+                           int x,
+                           int y,
+                           int num_x,
+                           int num_y);
+  // Small opaque shape centred on (x, y).
+  void SubmitPrimitive(RenderLayer layer,
+                       int sort_key,
+                       int x,
+                       int y,
+                       olc::Pixel color,
+                       PrimitiveShape shape);
+  // Many primitives under one sort key, as if each was submitted with SubmitPrimitive in order but
+  // as a single submission. The primitives are copied when the queue is flushed, they must outlive
+  // the call to Flush.
+  void SubmitPrimitives(RenderLayer layer,
+                        int sort_key,
+                        const Primitive* primitives,
+                        int num_primitives);
+  // Single opaque pixel.
+  void SubmitPoint(RenderLayer layer, int sort_key, int x, int y, olc::Pixel color) {
+    SubmitPrimitive(layer, sort_key, x, y, color, PrimitiveShape::kPoint);
+  }
+  // Opaque line, both ends included.
+  void SubmitLine(RenderLayer layer,
+                  int sort_key,
+                  int x0,
+                  int y0,
+                  int x1,
+                  int y1,
+                  olc::Pixel color);
+  // Opaque filled rectangle with its top left corner at (x, y).
+  void SubmitRect(RenderLayer layer,
+                  int sort_key,
+                  int x,
+                  int y,
+                  int width,
+                  int height,
+                  olc::Pixel color);
+  // Anything else. Runs serially, see DrawCommandList::RunSerial.
+  void SubmitCallback(RenderLayer layer, int sort_key, std::function<void()> fn);
+
+  [[nodiscard]] int GetNumSubmitted() const { return static_cast<int>(items_.size()); }
+
+  // Appends the submissions to the commands in draw order and empties the queue.
+  void Flush(DrawCommandList& commands);
+
+  // As Flush, and also finds the rows whose pixels can differ from what the previous call to
+  // FlushDamage drew: the rows covered by the draws that were not submitted in both frames, or
+  // that are drawn in a different order relative to each other, sorted and merged. Draws are
+  // compared by what they draw and where, images by their address.
+  // Returns false if the damage is unknown, i.e. on the first call, after a call to Flush, or if
+  // either frame submitted callbacks.
+  [[nodiscard]] bool FlushDamage(DrawCommandList& commands, std::vector<RowRange>& damaged_rows);
+
+ private:
+  enum class Kind : uint8_t {
+    kSprite,
+    kRepeatedImage,
+    kPrimitive,
+    kPrimitives,
+    kLine,
+    kRect,
+    kCallback
+  };
+
+  struct Item {
+    RenderLayer layer;
+    int sort_key;
+    int batch;  // Order of first submission of the source.
+    Kind kind;
+    int index;  // Into the vector of the kind.
+  };
+
+  struct SpriteDraw {
+    const olc::Pixel* pixels;
+    const SpriteSpans* spans;
+    int x;
+    int y;
+    olc::Sprite::Flip flip;
+  };
+  struct RepeatedImageDraw {
+    const olc::Sprite* image;
+    int x;
+    int y;
+    int num_x;
+    int num_y;
+  };
+  struct PrimitivesDraw {
+    const Primitive* primitives;
+    int num_primitives;
+  };
+  struct LineDraw {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    olc::Pixel color;
+  };
+  struct RectDraw {
+    int x;
+    int y;
+    int width;
+    int height;
+    olc::Pixel color;
+  };
+
+  // What a draw draws and where, enough to tell whether two frames drew the same without looking
+  // at images that may be gone by the next frame.
+  struct DrawRecord {
+    RenderLayer layer;
+    int sort_key;
+    Kind kind;
+    const void* source;  // The image, if any.
+    std::array<int, 5> values;
+    RowRange rows;
+  };
+
+  void Submit(RenderLayer layer, int sort_key, const void* source, Kind kind, int index);
+  // Appends the records of the item, one per primitive for batches of primitives, so they compare
+  // the same as primitives submitted one by one.
+  void AppendRecords(const Item& item, std::vector<DrawRecord>& records) const;
+  // Into draw order.
+  void SortItems();
+  void AppendCommands(DrawCommandList& commands);
+  void Clear();
+
+  std::vector<Item> items_;
+  std::unordered_map<const void*, int> batches_;  // Source to batch.
+  // Consecutive submissions mostly share the source, this saves looking it up.
+  const void* last_source_{nullptr};
+  int last_batch_{};
+  std::vector<SpriteDraw> sprites_;
+  std::vector<RepeatedImageDraw> repeated_images_;
+  std::vector<Primitive> primitives_;
+  std::vector<PrimitivesDraw> primitive_batches_;
+  std::vector<LineDraw> lines_;
+  std::vector<RectDraw> rects_;
+  std::vector<std::function<void()>> callbacks_;
+
+  // The draws of the previous call to FlushDamage, in draw order, if it did not submit callbacks.
+  bool has_previous_frame_{false};
+  std::vector<DrawRecord> previous_records_;
+};
+
+}  // namespace platformer
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "common_types/basic_types.h"
+#include "common_types/components.h"
+#include "common_types/entity.h"
+#include "common_types/sprite.h"
+#include "olcPixelGameEngine.h"
+
+namespace platformer {
+
+// Everything the renderer needs to know about one entity, copied out of the registry.
+struct RenderEntity {
+  EntityId id{};
+  Position position{};
+  std::optional<Direction> facing;
+  // The sprite frame is resolved when the snapshot is taken, so rendering does not need to touch
+  // the registry or the animation state.
+  std::optional<Sprite> sprite;
+  std::optional<PrimitiveComponent> primitive;
+  // Only filled in when collision boxes are being visualized.
+  std::optional<CollisionBox> collision_box;
+  std::optional<Collision> collisions;
+};
+
+// Particles, stored as parallel arrays like in the ParticleSystem.
+struct ParticleSnapshot {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<olc::Pixel> color;
+};
+
+// An immutable copy of the render relevant components of one frame.
+// This decouples rendering from the registry, so the simulation of the next frame can run
+// concurrently while this one is being drawn.
+struct RenderSnapshot {
+  std::vector<RenderEntity> entities;  // Sorted by entity id.
+  ParticleSnapshot particles;
+};
+
+}  // namespace platformer
@@ -0,0 +1,108 @@
+#include "sprite_spans.h"
+
+#include <algorithm>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+SpriteSpans::SpriteSpans(const olc::Sprite& sprite)
+    : SpriteSpans(const_cast<olc::Sprite&>(sprite).GetData(), sprite.width, sprite.height) {}
+
+SpriteSpans::SpriteSpans(const olc::Pixel* pixels, const int width, const int height)
+    : width_{width}, height_{height} {
+  bool any_transparent = false;
+  bool any_translucent = false;
+  row_starts_.reserve(height + 1);
+  for (int y = 0; y < height; ++y) {
+    const olc::Pixel* row = pixels + y * width;
+    for (int x = 0; x < width;) {
+      if (row[x].a == 0) {
+        any_transparent = true;
+        ++x;
+        continue;
+      }
+      const bool opaque = row[x].a == 255;
+      const int begin = x;
+      while (x < width && row[x].a != 0 && (row[x].a == 255) == opaque) {
+        ++x;
+      }
+      any_translucent |= !opaque;
+      spans_.push_back(PixelSpan{begin, x, opaque});
+    }
+    row_starts_.push_back(static_cast<int>(spans_.size()));
+  }
+
+  if (any_translucent) {
+    opacity_ = SpriteOpacity::kTrueAlpha;
+  } else if (any_transparent) {
+    opacity_ = SpriteOpacity::kBinaryAlpha;
+  }
+}
+
+void DrawSpans(const olc::Pixel* pixels,
+               const SpriteSpans& spans,
+               const int x,
+               const int y,
+               const olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               const BlitKernels& kernels) {
+  DrawSpans(pixels, spans, x, y, flip, target, RowRange{0, target.height}, kernels);
+}
+
+void DrawSpans(const olc::Pixel* pixels,
+               const SpriteSpans& spans,
+               const int x,
+               const int y,
+               const olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               const RowRange clip_rows,
+               const BlitKernels& kernels) {
+  const int width = spans.GetWidth();
+  const int height = spans.GetHeight();
+  const bool flip_x = (flip & olc::Sprite::Flip::HORIZ) != 0;
+  const bool flip_y = (flip & olc::Sprite::Flip::VERT) != 0;
+  // The visible part, in columns and rows relative to (x, y).
+  const int min_column = std::max(0, -x);
+  const int max_column = std::min(width, target.width - x);
+  const int min_row = std::max(0, std::max(clip_rows.begin, 0) - y);
+  const int max_row = std::min(height, std::min(clip_rows.end, target.height) - y);
+
+  for (int row = min_row; row < max_row; ++row) {
+    const int source_y = flip_y ? height - 1 - row : row;
+    const olc::Pixel* source = pixels + source_y * width;
+    olc::Pixel* destination = target.GetData() + (y + row) * target.width;
+    for (const PixelSpan* span = spans.RowBegin(source_y); span != spans.RowEnd(source_y);
+         ++span) {
+      if (!flip_x) {
+        const int begin = std::max(span->begin, min_column);
+        const int end = std::min(span->end, max_column);
+        if (begin < end) {
+          (span->opaque ? kernels.copy : kernels.blend)(source + begin, destination + x + begin,
+                                                        end - begin);
+        }
+        continue;
+      }
+      // Source columns [begin, end) land mirrored on columns [width - end, width - begin).
+      const int begin = std::max(width - span->end, min_column);
+      const int end = std::min(width - span->begin, max_column);
+      if (begin < end) {
+        (span->opaque ? kernels.copy_reversed : kernels.blend_reversed)(
+            source + width - end, destination + x + begin, end - begin);
+      }
+    }
+  }
+}
+
+void DrawSpans(const olc::Sprite& sprite,
+               const SpriteSpans& spans,
+               const int x,
+               const int y,
+               const olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               const BlitKernels& kernels) {
+  RB_CHECK(sprite.width == spans.GetWidth() && sprite.height == spans.GetHeight());
+  DrawSpans(const_cast<olc::Sprite&>(sprite).GetData(), spans, x, y, flip, target, kernels);
+}
+
+}  // namespace platformer
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/blitter.h"
+
+namespace platformer {
+
+enum class SpriteOpacity {
+  kOpaque,       // Every pixel is opaque.
+  kBinaryAlpha,  // Every pixel is either opaque or fully transparent.
+  kTrueAlpha,    // Some pixels are translucent.
+};
+
+// Pixels [begin, end) of one row, either all opaque or all translucent.
+struct PixelSpan {
+  int begin;
+  int end;
+  bool opaque;
+};
+
+// Rows [begin, end) of a draw target.
+struct RowRange {
+  int begin;
+  int end;
+};
+
+// Run-length encoding of the pixels of a sprite that need drawing, built once at load time.
+// Fully transparent pixels are not part of any span, so drawing skips them without looking at
+// them, and opaque spans are copied instead of blended.
+class SpriteSpans {
+ public:
+  SpriteSpans() = default;
+  explicit SpriteSpans(const olc::Sprite& sprite);
+  // Row major, width * height pixels.
+  SpriteSpans(const olc::Pixel* pixels, int width, int height);
+
+  [[nodiscard]] SpriteOpacity GetOpacity() const { return opacity_; }
+  [[nodiscard]] int GetWidth() const { return width_; }
+  [[nodiscard]] int GetHeight() const { return height_; }
+  [[nodiscard]] bool IsEmpty() const { return spans_.empty(); }
+
+  // The spans of row y, left to right.
+  [[nodiscard]] const PixelSpan* RowBegin(const int y) const {
+    return spans_.data() + row_starts_[y];
+  }
+  [[nodiscard]] const PixelSpan* RowEnd(const int y) const {
+    return spans_.data() + row_starts_[y + 1];
+  }
+
+ private:
+  SpriteOpacity opacity_{SpriteOpacity::kOpaque};
+  int width_{};
+  int height_{};
+  std::vector<PixelSpan> spans_;
+  std::vector<int> row_starts_{0};  // The spans of row y are [row_starts_[y], row_starts_[y + 1]).
+};
+
+// Draws the pixels described by the spans with their top left corner at (x, y), clipped to the
+// target. The result is the same as olc::PixelGameEngine::DrawSprite in the ALPHA pixel mode,
+// bar the alpha channel behind transparent pixels, which is left as is.
+// Horizontal flips use the reversed row kernels, vertical flips just walk the rows backwards.
+void DrawSpans(const olc::Pixel* pixels,
+               const SpriteSpans& spans,
+               int x,
+               int y,
+               olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               const BlitKernels& kernels = GetBestBlitKernels());
+
+// As above, but only draws the rows of the target within clip_rows.
+void DrawSpans(const olc::Pixel* pixels,
+               const SpriteSpans& spans,
+               int x,
+               int y,
+               olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               RowRange clip_rows,
+               const BlitKernels& kernels = GetBestBlitKernels());
+
+// As above, for the sprite the spans were built from.
+void DrawSpans(const olc::Sprite& sprite,
+               const SpriteSpans& spans,
+               int x,
+               int y,
+               olc::Sprite::Flip flip,
+               olc::Sprite& target,
+               const BlitKernels& kernels = GetBestBlitKernels());
+
+}  // namespace platformer
@@ -0,0 +1,159 @@
+#include "tile_chunk_cache.h"
+
+#include <algorithm>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+int FloorDiv(const int value, const int divisor) {
+  return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+}  // namespace
+
+TileChunkCache::TileChunkCache(const Level& level,
+                               const int chunk_size_tiles,
+                               const int max_cached_chunks,
+                               const int screen_width,
+                               const int screen_height)
+    : tile_grid_{level.tile_grid},
+      tileset_{level.level_tileset},
+      tile_size_{level.level_tileset->GetTileSize()},
+      chunk_size_tiles_{chunk_size_tiles},
+      chunk_size_px_{chunk_size_tiles * tile_size_},
+      num_chunks_x_{(tile_grid_.GetWidth() + chunk_size_tiles - 1) / chunk_size_tiles},
+      num_chunks_y_{(tile_grid_.GetHeight() + chunk_size_tiles - 1) / chunk_size_tiles},
+      max_cached_chunks_{static_cast<size_t>(
+          std::max(max_cached_chunks, GetMaxNumVisibleChunks(screen_width, screen_height)))} {
+  RB_CHECK(chunk_size_tiles > 0);
+  RB_CHECK(max_cached_chunks > 0);
+}
+
+void TileChunkCache::Draw(const int camera_px_x, const int camera_px_y, olc::Sprite& target) {
+  const auto range = GetVisibleChunks(camera_px_x, camera_px_y, target.width, target.height);
+  ForEachChunk(range, camera_px_x, camera_px_y, target.height,
+               [&](const Chunk& chunk, const int left, const int top) {
+                 DrawSpans(chunk.pixels.data(), chunk.spans, left, top, olc::Sprite::Flip::NONE,
+                           target);
+               });
+}
+
+void TileChunkCache::Submit(const int camera_px_x,
+                            const int camera_px_y,
+                            const int target_width,
+                            const int target_height,
+                            const RenderLayer layer,
+                            RenderQueue& queue) {
+  const auto range = GetVisibleChunks(camera_px_x, camera_px_y, target_width, target_height);
+  // Otherwise fetching the last chunks would evict some of the first, which are still referenced.
+  // Checked before any chunk is fetched, so nothing is evicted either way.
+  RB_CHECK(range.GetNumChunks() <= static_cast<int>(max_cached_chunks_));
+  ForEachChunk(range, camera_px_x, camera_px_y, target_height,
+               [&](const Chunk& chunk, const int left, const int top) {
+                 queue.SubmitSprite(layer, 0, chunk.pixels.data(), chunk.spans, left, top,
+                                    olc::Sprite::Flip::NONE);
+               });
+}
+
+int TileChunkCache::GetMaxNumVisibleChunks(const int target_width, const int target_height) const {
+  // A span of n pixels touches the most chunks when it starts on the last pixel of one.
+  const auto max_num_chunks = [&](const int num_px, const int num_chunks) {
+    return std::min(num_chunks, (chunk_size_px_ - 1 + num_px - 1) / chunk_size_px_ + 1);
+  };
+  return max_num_chunks(std::max(1, target_width), num_chunks_x_) *
+         max_num_chunks(std::max(1, target_height), num_chunks_y_);
+}
+
+TileChunkCache::ChunkRange TileChunkCache::GetVisibleChunks(const int camera_px_x,
+                                                            const int camera_px_y,
+                                                            const int target_width,
+                                                            const int target_height) const {
+  // Chunk (x, y) holds tiles [x, x + 1) * chunk size along each axis, y up.
+  return ChunkRange{
+      std::max(0, FloorDiv(camera_px_x, chunk_size_px_)),
+      std::min(num_chunks_x_ - 1, FloorDiv(camera_px_x + target_width - 1, chunk_size_px_)),
+      std::max(0, FloorDiv(camera_px_y, chunk_size_px_)),
+      std::min(num_chunks_y_ - 1, FloorDiv(camera_px_y + target_height - 1, chunk_size_px_)),
+  };
+}
+
+template <typename Fn>
+void TileChunkCache::ForEachChunk(const ChunkRange& range,
+                                  const int camera_px_x,
+                                  const int camera_px_y,
+                                  const int target_height,
+                                  Fn&& fn) {
+  for (int chunk_y = range.min_y; chunk_y <= range.max_y; ++chunk_y) {
+    for (int chunk_x = range.min_x; chunk_x <= range.max_x; ++chunk_x) {
+      const int left = chunk_x * chunk_size_px_ - camera_px_x;
+      const int top = target_height - (chunk_y + 1) * chunk_size_px_ + camera_px_y;
+      const Chunk& chunk = GetChunk(chunk_x, chunk_y);
+      if (!chunk.spans.IsEmpty()) {
+        fn(chunk, left, top);
+      }
+    }
+  }
+}
+
+void TileChunkCache::Clear() {
+  chunks_.clear();
+  chunk_index_.clear();
+}
+
+const TileChunkCache::Chunk& TileChunkCache::GetChunk(const int chunk_x, const int chunk_y) {
+  const int key = chunk_y * num_chunks_x_ + chunk_x;
+  const auto itr = chunk_index_.find(key);
+  if (itr != chunk_index_.end()) {
+    chunks_.splice(chunks_.begin(), chunks_, itr->second);
+    return chunks_.front();
+  }
+
+  if (chunks_.size() >= max_cached_chunks_) {
+    chunk_index_.erase(chunks_.back().key);
+    chunks_.pop_back();
+  }
+  chunks_.emplace_front();
+  BuildChunk(chunk_x, chunk_y, chunks_.front());
+  chunk_index_.emplace(key, chunks_.begin());
+  ++num_chunks_built_;
+  return chunks_.front();
+}
+
+void TileChunkCache::BuildChunk(const int chunk_x, const int chunk_y, Chunk& chunk) const {
+  chunk.key = chunk_y * num_chunks_x_ + chunk_x;
+  chunk.pixels.assign(chunk_size_px_ * chunk_size_px_, olc::BLANK);
+
+  // Only the tile_size x tile_size top left corner of each tile sprite is used.
+  const int min_tile_x = chunk_x * chunk_size_tiles_;
+  const int min_tile_y = chunk_y * chunk_size_tiles_;
+  const int max_tile_x = std::min(tile_grid_.GetWidth(), min_tile_x + chunk_size_tiles_);
+  const int max_tile_y = std::min(tile_grid_.GetHeight(), min_tile_y + chunk_size_tiles_);
+  for (int tile_y = min_tile_y; tile_y < max_tile_y; ++tile_y) {
+    for (int tile_x = min_tile_x; tile_x < max_tile_x; ++tile_x) {
+      const int tile_id = tile_grid_.GetTile(tile_x, tile_y).tile_id;
+      if (tile_id == 0) {
+        continue;
+      }
+      olc::Sprite* tile = tileset_->GetTile(tile_id);
+      const int left = (tile_x - min_tile_x) * tile_size_;
+      const int top = (min_tile_y + chunk_size_tiles_ - 1 - tile_y) * tile_size_;
+      const int width = std::min(tile->width, tile_size_);
+      const int height = std::min(tile->height, tile_size_);
+      for (int y = 0; y < height; ++y) {
+        const olc::Pixel* source = tile->GetData() + y * tile->width;
+        olc::Pixel* destination = chunk.pixels.data() + (top + y) * chunk_size_px_ + left;
+        std::copy(source, source + width, destination);
+      }
+    }
+  }
+
+  chunk.spans = SpriteSpans{chunk.pixels.data(), chunk_size_px_, chunk_size_px_};
+  if (chunk.spans.IsEmpty()) {
+    chunk.pixels = {};
+  }
+}
+
+}  // namespace platformer
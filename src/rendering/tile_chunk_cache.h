@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common_types/game_configuration.h"
+#include "common_types/grid.h"
+#include "common_types/tileset.h"
+#include "olcPixelGameEngine.h"
+#include "rendering/render_queue.h"
+#include "rendering/sprite_spans.h"
+
+namespace platformer {
+
+// The tile layer of a level, pre-rendered into square chunks of tiles.
+//
+// The tiles never change at runtime, so instead of drawing every visible tile every frame, the
+// chunks are built the first time they come into view and kept in a least recently used cache.
+// Chunks are drawn through their SpriteSpans, i.e. a copy per opaque span.
+class TileChunkCache {
+ public:
+  // The tile grid is copied in, the tileset is shared.
+  // The cache holds at least the chunks a screen of the given size can show, so the submissions for
+  // one screen never evict each other.
+  TileChunkCache(const Level& level,
+                 int chunk_size_tiles,
+                 int max_cached_chunks,
+                 int screen_width,
+                 int screen_height);
+
+  // Draws the tiles seen by a camera whose bottom left corner is at the given pixel, with y up.
+  // The result is the same as drawing every tile with DrawSprite in the ALPHA pixel mode, bar the
+  // alpha channel of pixels behind transparent ones, which is left as is.
+  void Draw(int camera_px_x, int camera_px_y, olc::Sprite& target);
+
+  // As Draw, but submits the chunks for a target of the given size to the queue instead.
+  // The submissions point into the cache, they are valid until the cache is next used. Targets
+  // larger than the screen the cache was sized for are rejected if they show too many chunks.
+  void Submit(int camera_px_x,
+              int camera_px_y,
+              int target_width,
+              int target_height,
+              RenderLayer layer,
+              RenderQueue& queue);
+
+  // Drops all cached chunks.
+  void Clear();
+
+  [[nodiscard]] int GetNumCachedChunks() const { return static_cast<int>(chunks_.size()); }
+  [[nodiscard]] int GetMaxNumCachedChunks() const { return static_cast<int>(max_cached_chunks_); }
+  // Total number of chunks built, including rebuilds of evicted ones.
+  [[nodiscard]] int GetNumChunksBuilt() const { return num_chunks_built_; }
+
+ private:
+  struct Chunk {
+    int key;
+    std::vector<olc::Pixel> pixels;  // Empty if the chunk has no tiles.
+    SpriteSpans spans;
+  };
+
+  // The chunks seen by a camera, inclusive. Empty if min > max along either axis.
+  struct ChunkRange {
+    int min_x;
+    int max_x;
+    int min_y;
+    int max_y;
+
+    [[nodiscard]] int GetNumChunks() const {
+      return std::max(0, max_x - min_x + 1) * std::max(0, max_y - min_y + 1);
+    }
+  };
+
+  // The most chunks a target of the given size can show, wherever the camera is.
+  [[nodiscard]] int GetMaxNumVisibleChunks(int target_width, int target_height) const;
+  [[nodiscard]] ChunkRange GetVisibleChunks(int camera_px_x,
+                                            int camera_px_y,
+                                            int target_width,
+                                            int target_height) const;
+  // Calls fn(chunk, left, top) for every non empty chunk in range, where left and top are the
+  // position of the chunk on a target of the given height.
+  template <typename Fn>
+  void ForEachChunk(const ChunkRange& range,
+                    int camera_px_x,
+                    int camera_px_y,
+                    int target_height,
+                    Fn&& fn);
+  const Chunk& GetChunk(int chunk_x, int chunk_y);
+  void BuildChunk(int chunk_x, int chunk_y, Chunk& chunk) const;
+
+  Grid<Tile> tile_grid_;
+  std::shared_ptr<const TileSet> tileset_;
+  int tile_size_;
+  int chunk_size_tiles_;
+  int chunk_size_px_;
+  int num_chunks_x_;
+  int num_chunks_y_;
+  size_t max_cached_chunks_;
+
+  std::list<Chunk> chunks_;  // Most recently used first.
+  std::unordered_map<int, std::list<Chunk>::iterator> chunk_index_;
+  int num_chunks_built_{};
+};
+
+}  // namespace platformer
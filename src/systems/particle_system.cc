@@ -0,0 +1,207 @@
+#include "particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace platformer {
+
+constexpr double kMaxParticles = 100000;
+constexpr double kRicochetLifetime = 0.5;
+constexpr int kParticlesPerRicochet = 5;
+
+// Minimum number of particles per job.
+constexpr int kParticleGrainSize = 4096;
+
+namespace {
+
+// Particles stop this far short of a solid tile.
+constexpr float kBoundaryGap = 1e-3f;
+
+// As std::floor, which is a library call without SSE4.1.
+int FloorInt(const float value) {
+  const int truncated = static_cast<int>(value);
+  return truncated - (value < static_cast<float>(truncated) ? 1 : 0);
+}
+
+// Where a particle coming from tile `from` stops in front of the solid tile `solid`.
+float StopInFront(const int from, const int solid) {
+  return solid > from ? solid - kBoundaryGap : solid + 1 + kBoundaryGap;
+}
+
+// The first solid tile after `from`, up to and including `to`. Most particles only entered the
+// next tile, longer spans are tested as a whole with any_solid(min, max) first.
+template <typename IsSolid, typename AnySolid>
+std::optional<int> FindFirstSolid(const int from,
+                                  const int to,
+                                  IsSolid is_solid,
+                                  AnySolid any_solid) {
+  const int step = to > from ? 1 : -1;
+  if (to != from + step && !any_solid(std::min(from + step, to), std::max(from + step, to))) {
+    return std::nullopt;
+  }
+  for (int tile = from + step; tile != to + step; tile += step) {
+    if (is_solid(tile)) {
+      return tile;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+ParticleSystem::ParticleSystem(const Level& level,
+                               std::shared_ptr<ParameterServer> parameter_server,
+                               std::shared_ptr<const RandomNumberGenerator> rng,
+                               std::shared_ptr<JobSystem> job_system)
+    : solid_tiles_{BitGrid::FromGrid(level.property_grid, kSolidProperty)},
+      parameter_server_{std::move(parameter_server)},
+      rng_{std::move(rng)},
+      job_system_{std::move(job_system)} {
+  parameter_server_->AddParameter("particles/max.count", kMaxParticles,
+                                  "Maximum number of live particles, new ones are dropped.");
+}
+
+bool ParticleSystem::Emit(const Vector2d& position,
+                          const Vector2d& velocity,
+                          const olc::Pixel& color,
+                          const double lifetime_s) {
+  const auto max_count = parameter_server_->GetParameter<double>("particles/max.count");
+  if (GetNumParticles() >= max_count) {
+    return false;
+  }
+  x_.push_back(static_cast<float>(position.x));
+  y_.push_back(static_cast<float>(position.y));
+  velocity_x_.push_back(static_cast<float>(velocity.x));
+  velocity_y_.push_back(static_cast<float>(velocity.y));
+  lifetime_.push_back(static_cast<float>(lifetime_s));
+  color_.push_back(color);
+  return true;
+}
+
+void ParticleSystem::SpawnRicochets(const std::vector<Ricochet>& ricochets) {
+  for (const auto& ricochet : ricochets) {
+    const auto& position = ricochet.position;
+    const auto& velocity = ricochet.velocity;
+    for (int i = 0; i < kParticlesPerRicochet; ++i) {
+      const Vector2d particle_velocity{
+          std::copysign(rng_->RandomInt(0, 49) / 10., velocity.x),
+          std::copysign(rng_->RandomInt(0, 49) / 10., velocity.y)};
+      const auto shade = static_cast<uint8_t>(rng_->RandomInt(128, 255));
+      Emit(Vector2d{position.x, position.y}, particle_velocity, olc::Pixel{shade, shade, shade},
+           kRicochetLifetime);
+    }
+  }
+}
+
+void ParticleSystem::Update(const double delta_t) {
+  const auto gravity =
+      static_cast<float>(parameter_server_->GetParameter<double>("physics/gravity"));
+  previous_position_.resize(x_.size());
+  job_system_->ParallelForRange(
+      0, GetNumParticles(),
+      [this, delta_t, gravity](const int begin, const int end) {
+        MoveParticles(begin, end, static_cast<float>(delta_t), gravity);
+      },
+      kParticleGrainSize);
+  RemoveExpired();
+}
+
+void ParticleSystem::MoveParticles(const int begin,
+                                   const int end,
+                                   const float delta_t,
+                                   const float gravity) {
+  for (int i = begin; i < end; ++i) {
+    lifetime_[i] -= delta_t;
+    velocity_y_[i] -= gravity * delta_t;
+  }
+
+  // Each axis moves on its own, stopping in front of the first solid tile on the way. Only the
+  // particles that left their tile are tested against the solid tiles.
+  for (int i = begin; i < end; ++i) {
+    previous_position_[i] = x_[i];
+    x_[i] += velocity_x_[i] * delta_t;
+  }
+  for (int i = begin; i < end; ++i) {
+    const int from = FloorInt(previous_position_[i]);
+    const int to = FloorInt(x_[i]);
+    if (from == to) {
+      continue;
+    }
+    const int row = FloorInt(y_[i]);
+    const auto column = FindFirstSolid(
+        from, to, [this, row](const int x) { return solid_tiles_.Get(x, row); },
+        [this, row](const int min_x, const int max_x) {
+          return solid_tiles_.AnyInRow(row, min_x, max_x);
+        });
+    if (column.has_value()) {
+      x_[i] = StopInFront(from, *column);
+      velocity_x_[i] = 0.f;
+    }
+  }
+
+  for (int i = begin; i < end; ++i) {
+    previous_position_[i] = y_[i];
+    y_[i] += velocity_y_[i] * delta_t;
+  }
+  for (int i = begin; i < end; ++i) {
+    const int from = FloorInt(previous_position_[i]);
+    const int to = FloorInt(y_[i]);
+    if (from == to) {
+      continue;
+    }
+    const int column = FloorInt(x_[i]);
+    const auto row = FindFirstSolid(
+        from, to, [this, column](const int y) { return solid_tiles_.Get(column, y); },
+        [this, column](const int min_y, const int max_y) {
+          return solid_tiles_.AnyInColumn(column, min_y, max_y);
+        });
+    if (row.has_value()) {
+      y_[i] = StopInFront(from, *row);
+      velocity_y_[i] = 0.f;
+    }
+  }
+}
+
+void ParticleSystem::RemoveExpired() {
+  // Compacts the arrays in place, keeping the order of the remaining particles.
+  const int num_particles = GetNumParticles();
+  int num_alive = 0;
+  for (int i = 0; i < num_particles; ++i) {
+    if (lifetime_[i] <= 0.f) {
+      continue;
+    }
+    if (num_alive != i) {
+      x_[num_alive] = x_[i];
+      y_[num_alive] = y_[i];
+      velocity_x_[num_alive] = velocity_x_[i];
+      velocity_y_[num_alive] = velocity_y_[i];
+      lifetime_[num_alive] = lifetime_[i];
+      color_[num_alive] = color_[i];
+    }
+    ++num_alive;
+  }
+  x_.resize(num_alive);
+  y_.resize(num_alive);
+  velocity_x_.resize(num_alive);
+  velocity_y_.resize(num_alive);
+  lifetime_.resize(num_alive);
+  color_.resize(num_alive);
+}
+
+void ParticleSystem::Clear() {
+  x_.clear();
+  y_.clear();
+  velocity_x_.clear();
+  velocity_y_.clear();
+  lifetime_.clear();
+  color_.clear();
+}
+
+void ParticleSystem::Capture(ParticleSnapshot& snapshot) const {
+  snapshot.x = x_;
+  snapshot.y = y_;
+  snapshot.color = color_;
+}
+
+}  // namespace platformer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common_types/basic_types.h"
+#include "common_types/bit_grid.h"
+#include "common_types/game_configuration.h"
+#include "olcPixelGameEngine.h"
+#include "rendering/render_snapshot.h"
+#include "systems/physics_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+#include "utils/random_number_generator.h"
+
+namespace platformer {
+
+// Cosmetic particles, e.g. sparks from ricochets.
+//
+// Particles never interact with entities, so they are kept out of the registry in a pool of
+// parallel arrays. The update is a few branch free passes over those arrays, which the compiler
+// vectorizes, and a collision test against the solid tile bitmap for the particles that moved
+// into another tile. Particles fall under
+// "physics/gravity", stop moving along an axis on hitting a solid tile and disappear once their
+// lifetime is over.
+class ParticleSystem {
+ public:
+  ParticleSystem(const Level& level,
+                 std::shared_ptr<ParameterServer> parameter_server,
+                 std::shared_ptr<const RandomNumberGenerator> rng,
+                 std::shared_ptr<JobSystem> job_system);
+
+  // Returns false if the pool is full.
+  bool Emit(const Vector2d& position,
+            const Vector2d& velocity,
+            const olc::Pixel& color,
+            double lifetime_s);
+  // A few sparks flying off where the projectile bounced.
+  void SpawnRicochets(const std::vector<Ricochet>& ricochets);
+
+  void Update(double delta_t);
+  void Clear();
+
+  // Copies what is needed to draw the particles.
+  void Capture(ParticleSnapshot& snapshot) const;
+
+  [[nodiscard]] int GetNumParticles() const { return static_cast<int>(x_.size()); }
+
+ private:
+  void MoveParticles(int begin, int end, float delta_t, float gravity);
+  void RemoveExpired();
+
+  BitGrid solid_tiles_;
+  std::shared_ptr<ParameterServer> parameter_server_;
+  std::shared_ptr<const RandomNumberGenerator> rng_;
+  std::shared_ptr<JobSystem> job_system_;
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> velocity_x_;
+  std::vector<float> velocity_y_;
+  std::vector<float> lifetime_;  // Remaining, in seconds.
+  std::vector<olc::Pixel> color_;
+  // Scratch space for MoveParticles: the positions before the move along the current axis.
+  std::vector<float> previous_position_;
+};
+
+}  // namespace platformer
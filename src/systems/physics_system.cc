@@ -1,14 +1,18 @@
 #include "physics_system.h"
 
 #include <algorithm>
+#include <cmath>
+#include <mutex>
 #include <unordered_map>
 
 #include "common_types/actor_state.h"
 #include "common_types/basic_types.h"
 #include "common_types/components.h"
 #include "common_types/entity.h"
+#include "common_types/ray_casting.h"
 #include "registry.h"
 #include "registry_helpers.h"
+#include "registry_parallel.h"
 #include "utils/game_clock.h"
 #include "utils/logging.h"
 #include "utils/parameter_server.h"
@@ -21,9 +25,36 @@ constexpr double kGravity = 50.0;
 constexpr double kGroundFriction = 50.0;
 constexpr double kAirFriction = 1.0;
 constexpr double kSlideFriction = 7.0;  // For backdodge
+constexpr double kSleepFrames = 30;
+
+// Minimum number of entities per job. Actors sample the collision grid several times per step,
+// projectiles only once.
+constexpr int kActorGrainSize = 64;
+constexpr int kProjectileGrainSize = 512;
+constexpr int kRayGrainSize = 64;
+
+// A projectile stops at the wall after this many bounces within one step.
+constexpr int kMaxBouncesPerStep = 4;
 
 namespace platformer {
 
+namespace {
+
+// Boxes are clamped kEps short of a solid tile and may end up within rounding error of a tile
+// boundary. Edges within kSkin of a boundary do not count as covering the tile beyond it.
+constexpr double kEps = 1e-6;
+constexpr double kSkin = 1e-6;
+
+int FloorInt(const double value) { return static_cast<int>(std::floor(value)); }
+
+bool operator==(const CollisionBox& lhs, const CollisionBox& rhs) {
+  return lhs.x_offset_px == rhs.x_offset_px && lhs.y_offset_px == rhs.y_offset_px &&
+         lhs.collision_width_px == rhs.collision_width_px &&
+         lhs.collision_height_px == rhs.collision_height_px;
+}
+
+}  // namespace
+
 void UpdateCollisionsChanged(Collision& collisions, const Collision& old_collisions) {
   collisions.left_changed = collisions.left != old_collisions.left;
   collisions.right_changed = collisions.right != old_collisions.right;
@@ -43,92 +74,15 @@ BoundingBox GetCollisionBoxInGlobalCoordinates(const Position& position,
           position.y + y_offset + collision_height};
 }
 
-bool IsCollision(const Grid<int>& collision_grid, double x, double y) {
-  constexpr int kSolid = 1;
-  const int int_x = static_cast<int>(std::floor(x));
-  const int int_y = static_cast<int>(std::floor(y));
-  if (int_x < 0 || int_y < 0 || int_x >= collision_grid.GetWidth() ||
-      int_y >= collision_grid.GetHeight()) {
-    return false;
-  }
-  return collision_grid.GetTile(int_x, int_y) == kSolid;
-}
-
-void ResolvePointCollision(const Grid<int>& collision_grid,
-                           const Axis axis,
-                           Position& position,
-                           Velocity& velocity) {
-  const int int_x = static_cast<int>(std::floor(position.x));
-  const int int_y = static_cast<int>(std::floor(position.y));
-  if (!IsCollision(collision_grid, position.x, position.y)) {
-    return;
-  }
-  if (axis == Axis::X) {
-    position.x = std::round(position.x);
-    velocity.x = -velocity.x;
-    return;
-  }
-  position.y = std::round(position.y);
-  velocity.x = 0;
-  velocity.y = 0;
-}
-
-AxisCollisions PhysicsSystem::CheckAxisCollision(const Position& position,
-                                                 const CollisionBox& bounding_box,
-                                                 const Axis axis) const {
-  constexpr double kLowerSamplePercent = 0.2;
-  constexpr double kMiddlSamplePercent = 0.5;
-  constexpr double kUpperSamplePercent = 0.8;
-  const auto player_box = GetCollisionBoxInGlobalCoordinates(position, bounding_box, tile_size_);
-
-  std::vector<Vector2d> lower_collision_points;
-  std::vector<Vector2d> upper_collision_points;
-  if (axis == Axis::X) {
-    const auto box_height = player_box.top - player_box.bottom;
-    lower_collision_points = {
-        {player_box.left, player_box.bottom + box_height * kLowerSamplePercent},
-        {player_box.left, player_box.bottom + box_height * kMiddlSamplePercent},
-        {player_box.left, player_box.bottom + box_height * kUpperSamplePercent},
-    };
-    upper_collision_points = {
-        {player_box.right, player_box.bottom + box_height * kLowerSamplePercent},
-        {player_box.right, player_box.bottom + box_height * kMiddlSamplePercent},
-        {player_box.right, player_box.bottom + box_height * kUpperSamplePercent},
-    };
-  } else {
-    const auto box_width = player_box.right - player_box.left;
-    lower_collision_points = {
-        {player_box.left + box_width * kLowerSamplePercent, player_box.bottom},
-        {player_box.left + box_width * kMiddlSamplePercent, player_box.bottom},
-        {player_box.left + box_width * kUpperSamplePercent, player_box.bottom},
-    };
-    upper_collision_points = {
-        {player_box.left + box_width * kLowerSamplePercent, player_box.top},
-        {player_box.left + box_width * kMiddlSamplePercent, player_box.top},
-        {player_box.left + box_width * kUpperSamplePercent, player_box.top},
-    };
-  }
-
-  bool lower_collision{};
-  bool upper_collision{};
-  for (const auto& pt : lower_collision_points) {
-    lower_collision |= IsCollision(collisions_grid_, pt.x, pt.y);
-  }
-  for (const auto& pt : upper_collision_points) {
-    upper_collision |= IsCollision(collisions_grid_, pt.x, pt.y);
-  }
-  return {lower_collision, upper_collision};
-}
-
-void PhysicsSystem::ResolveCollisions(EntityId id,
-                                      const Axis& axis,
-                                      const int tile_size,
-                                      const bool lower_collision,
-                                      const bool upper_collision) {
-  auto [position, velocity, collision_box, collisions] =
-      registry_->GetComponents<Position, Velocity, CollisionBox, Collision>(id);
+void ResolveCollisions(const Axis& axis,
+                       const int tile_size,
+                       const bool lower_collision,
+                       const bool upper_collision,
+                       const CollisionBox& collision_box,
+                       Position& position,
+                       Velocity& velocity,
+                       Collision& collisions) {
   const auto player_box = GetCollisionBoxInGlobalCoordinates(position, collision_box, tile_size);
-  constexpr double kEps = 1e-6;
   if (axis == Axis::X) {
     const auto x_offset = static_cast<double>(collision_box.x_offset_px) / tile_size;
     const auto collision_width = static_cast<double>(collision_box.collision_width_px) / tile_size;
@@ -161,13 +115,107 @@ void PhysicsSystem::ResolveCollisions(EntityId id,
   }
 }
 
+AxisCollisions PhysicsSystem::CheckAxisCollision(const Position& position,
+                                                 const CollisionBox& bounding_box,
+                                                 const Axis axis) const {
+  // Tests every tile along the lower and upper edge. Tiles only touching the box along one of its
+  // sides, e.g. the ground below a standing box, do not count for the perpendicular edges.
+  const auto box = GetCollisionBoxInGlobalCoordinates(position, bounding_box, tile_size_);
+  if (axis == Axis::X) {
+    const int min_row = FloorInt(box.bottom + kSkin);
+    const int max_row = FloorInt(box.top - kSkin);
+    return {solid_tiles_.AnyInColumn(FloorInt(box.left), min_row, max_row),
+            solid_tiles_.AnyInColumn(FloorInt(box.right), min_row, max_row)};
+  }
+  const int min_column = FloorInt(box.left + kSkin);
+  const int max_column = FloorInt(box.right - kSkin);
+  return {solid_tiles_.AnyInRow(FloorInt(box.bottom), min_column, max_column),
+          solid_tiles_.AnyInRow(FloorInt(box.top), min_column, max_column)};
+}
+
+void PhysicsSystem::SweepAxis(const Axis axis,
+                              const double distance,
+                              const CollisionBox& collision_box,
+                              Position& position,
+                              Velocity& velocity,
+                              Collision& collisions) const {
+  const auto box = GetCollisionBoxInGlobalCoordinates(position, collision_box, tile_size_);
+  const double x_offset = static_cast<double>(collision_box.x_offset_px) / tile_size_;
+  const double y_offset = static_cast<double>(collision_box.y_offset_px) / tile_size_;
+  const double width = static_cast<double>(collision_box.collision_width_px) / tile_size_;
+  const double height = static_cast<double>(collision_box.collision_height_px) / tile_size_;
+  // Outside of the level nothing is solid, so only lines inside of it need to be checked.
+  const int max_column = solid_tiles_.GetWidth() - 1;
+  const int max_row = solid_tiles_.GetHeight() - 1;
+
+  if (axis == Axis::X) {
+    const int min_row_covered = FloorInt(box.bottom + kSkin);
+    const int max_row_covered = FloorInt(box.top - kSkin);
+    if (distance > 0) {
+      const int first = std::max(0, FloorInt(box.right - kSkin) + 1);
+      const int last = std::min(max_column, FloorInt(box.right + distance - kSkin));
+      for (int column = first; column <= last; ++column) {
+        if (solid_tiles_.AnyInColumn(column, min_row_covered, max_row_covered)) {
+          position.x = column - x_offset - width - kEps;
+          velocity.x = std::min(velocity.x, 0.);
+          collisions.right = true;
+          return;
+        }
+      }
+    } else if (distance < 0) {
+      const int first = std::min(max_column, FloorInt(box.left + kSkin) - 1);
+      const int last = std::max(0, FloorInt(box.left + distance + kSkin));
+      for (int column = first; column >= last; --column) {
+        if (solid_tiles_.AnyInColumn(column, min_row_covered, max_row_covered)) {
+          position.x = column + 1 - x_offset;
+          velocity.x = std::max(velocity.x, 0.);
+          collisions.left = true;
+          return;
+        }
+      }
+    }
+    position.x += distance;
+    return;
+  }
+
+  const int min_column_covered = FloorInt(box.left + kSkin);
+  const int max_column_covered = FloorInt(box.right - kSkin);
+  if (distance > 0) {
+    const int first = std::max(0, FloorInt(box.top - kSkin) + 1);
+    const int last = std::min(max_row, FloorInt(box.top + distance - kSkin));
+    for (int row = first; row <= last; ++row) {
+      if (solid_tiles_.AnyInRow(row, min_column_covered, max_column_covered)) {
+        position.y = row - y_offset - height - kEps;
+        velocity.y = std::min(velocity.y, 0.);
+        collisions.top = true;
+        return;
+      }
+    }
+  } else if (distance < 0) {
+    const int first = std::min(max_row, FloorInt(box.bottom + kSkin) - 1);
+    const int last = std::max(0, FloorInt(box.bottom + distance + kSkin));
+    for (int row = first; row >= last; --row) {
+      if (solid_tiles_.AnyInRow(row, min_column_covered, max_column_covered)) {
+        position.y = row + 1 - y_offset;
+        velocity.y = std::max(velocity.y, 0.);
+        collisions.bottom = true;
+        return;
+      }
+    }
+  }
+  position.y += distance;
+}
+
 PhysicsSystem::PhysicsSystem(const Level& level,
                              std::shared_ptr<ParameterServer> parameter_server,
+                             std::shared_ptr<JobSystem> job_system,
                              std::shared_ptr<Registry> registry)
     : tile_size_{level.level_tileset->GetTileSize()},
-      collisions_grid_{level.property_grid},
-      occupancy_grid_{collisions_grid_.GetWidth(), collisions_grid_.GetHeight()},
+      solid_tiles_{BitGrid::FromGrid(level.property_grid, kSolidProperty)},
+      distance_field_{solid_tiles_},
+      broadphase_{solid_tiles_.GetWidth(), solid_tiles_.GetHeight()},
       parameter_server_{std::move(parameter_server)},
+      job_system_{std::move(job_system)},
       registry_{std::move(registry)} {
   parameter_server_->AddParameter("physics/gravity", kGravity, "Gravity, unit is tile/s^2");
   parameter_server_->AddParameter("physics/max.x.vel", kMaxVelX,
@@ -184,147 +232,161 @@ PhysicsSystem::PhysicsSystem(const Level& level,
                                   "Controls deceleration in the air.");
   parameter_server_->AddParameter("physics/slide.friction", kSlideFriction,
                                   "Controls deceleration in the air.");
+  parameter_server_->AddParameter(
+      "physics/sleep.frames", kSleepFrames,
+      "Number of steps an actor has to rest on the ground before it sleeps. 0 disables sleeping.");
 }
 
-std::vector<Axis> PhysicsSystem::MoveParticleCheckCollision(const EntityId id,
-                                                            const double delta_t) {
-  constexpr double kEps = 1e-4;
-  auto [velocity, position] = registry_->GetComponents<Velocity, Position>(id);
-  Position trial_position{position.x + velocity.x * delta_t,  //
-                          position.y + velocity.y * delta_t};
-  auto tile_x = static_cast<int>(std::floor(position.x));
-  auto tile_y = static_cast<int>(std::floor(position.y));
-  auto trial_tile_x = static_cast<int>(std::floor(trial_position.x));
-  auto trial_tile_y = static_cast<int>(std::floor(trial_position.y));
-
-  if (tile_x == trial_tile_x && tile_y == trial_tile_y) {
-    std::swap(position, trial_position);
-    return {};
-  }
-  std::vector<Axis> return_axes;
-  // This 'walks' the trial position back to the starting position, one boundary at a time.
-  // Each time it is moved it is checked for collisions again.
-  // This approach works for crossing diagonally, and crossing multiple cells.
-  int attempts{};
-  constexpr int kMaxAttempts = 10;
-  while (IsCollision(collisions_grid_, trial_position.x, trial_position.y) &&
-         attempts++ < kMaxAttempts) {
-    trial_tile_x = static_cast<int>(std::floor(trial_position.x));
-    trial_tile_y = static_cast<int>(std::floor(trial_position.y));
-    if (trial_tile_x != tile_x) {
-      if (velocity.x < 0) {
-        trial_tile_x += 1;
+int PhysicsSystem::MoveParticleCheckCollision(const double delta_t,
+                                              const bool bounce,
+                                              Position& position,
+                                              Velocity& velocity,
+                                              const EntityId id,
+                                              std::vector<ProjectilePath>* path) const {
+  constexpr double kBoundaryGap = 1e-4;
+  const auto is_solid = [this](const int x, const int y) { return solid_tiles_.Get(x, y); };
+
+  // Walk the cells along the way, so nothing is skipped however far it moves in one step.
+  double remaining_fraction = 1.;
+  int num_bounces = 0;
+  while (true) {
+    const Vector2d start{position.x, position.y};
+    const Vector2d delta{velocity.x * delta_t * remaining_fraction,
+                         velocity.y * delta_t * remaining_fraction};
+    Vector2d end = start + delta;
+    // Most of the time there is nothing solid anywhere near.
+    if (std::max(std::abs(delta.x), std::abs(delta.y)) <
+        distance_field_.GetFreeDistance(start.x, start.y)) {
+      position.x = end.x;
+      position.y = end.y;
+      if (path != nullptr) {
+        path->push_back(ProjectilePath{id, start, end});
       }
-      const double x_dist = trial_tile_x - position.x;
-      const double gradient = (trial_position.y - position.y) / (trial_position.x - position.x);
-      trial_position.x = trial_tile_x - std::copysign(kEps, velocity.x);
-      trial_position.y = position.y + gradient * x_dist;
-      return_axes.push_back(Axis::X);
-      continue;
+      return num_bounces;
     }
-    if (trial_tile_y != tile_y) {
-      if (velocity.y < 0) {
-        trial_tile_y += 1;
+    const auto crossing = FindFirstSolidCrossing(start, delta, is_solid);
+    if (crossing.has_value()) {
+      // Stop just short of the boundary that was hit.
+      end = Vector2d{start.x + delta.x * crossing->t, start.y + delta.y * crossing->t};
+      if (crossing->axis == Axis::X) {
+        const int boundary = delta.x > 0 ? crossing->cell_x : crossing->cell_x + 1;
+        end.x = boundary - std::copysign(kBoundaryGap, delta.x);
+      } else {
+        const int boundary = delta.y > 0 ? crossing->cell_y : crossing->cell_y + 1;
+        end.y = boundary - std::copysign(kBoundaryGap, delta.y);
       }
-      const double y_dist = trial_tile_y - position.y;
-      const double gradient = (trial_position.x - position.x) / (trial_position.y - position.y);
-      trial_position.x = position.x + gradient * y_dist;
-      trial_position.y = trial_tile_y - std::copysign(kEps, velocity.y);
-      return_axes.push_back(Axis::Y);
     }
-  }
-  if (attempts >= kMaxAttempts) {
-    LOG_ERROR("GOT STUCK ATTEMPTING TO MOVE PARTICLE");
-  }
-  position = trial_position;
-  return return_axes;
-}
-
-void PhysicsSystem::PhysicsStepImpl(const double delta_t) {
-  for (auto id : registry_->GetView<Acceleration, Velocity>()) {
-    auto [acceleration, velocity] = registry_->GetComponents<Acceleration, Velocity>(id);
-    velocity.x += acceleration.x * delta_t;
-    velocity.x = std::min(velocity.x, velocity.max_x);
-    velocity.x = std::max(velocity.x, -velocity.max_x);
-
-    velocity.y += acceleration.y * delta_t;
-    velocity.y = std::min(velocity.y, velocity.max_y);
-    velocity.y = std::max(velocity.y, -velocity.max_y);
-  }
-
-  for (auto id : registry_->GetView<Velocity, Position, CollisionBox, Collision>()) {
-    auto [velocity, position, collision_box, collisions] =
-        registry_->GetComponents<Velocity, Position, CollisionBox, Collision>(id);
-
-    Collision old_collisions = collisions;
-    collisions = {};
-
-    position.x += velocity.x * delta_t;
-    this->CheckCollisionBox(id, Axis::X);
-
-    position.y += velocity.y * delta_t;
-    this->CheckCollisionBox(id, Axis::Y);
-
-    UpdateCollisionsChanged(collisions, old_collisions);
-  }
-
-  for (auto id : registry_->GetView<Velocity, Position, Projectile>()) {
-    const auto axes = MoveParticleCheckCollision(id, delta_t);
-    auto [velocity, position] = registry_->GetComponents<Velocity, Position>(id);
-
-    if (axes.empty()) {
-      continue;
+    position.x = end.x;
+    position.y = end.y;
+    if (path != nullptr) {
+      path->push_back(ProjectilePath{id, start, end});
+    }
+    if (!crossing.has_value() || !bounce || num_bounces == kMaxBouncesPerStep) {
+      return num_bounces;
     }
 
-    if (std::find(axes.begin(), axes.end(), Axis::X) != axes.end()) {
+    ++num_bounces;
+    remaining_fraction *= 1. - crossing->t;
+    if (crossing->axis == Axis::X) {
       velocity.x *= -1;
-    }
-    if (std::find(axes.begin(), axes.end(), Axis::Y) != axes.end()) {
+    } else {
       velocity.y *= -1;
     }
+  }
+}
 
-    if (registry_->HasComponent<FacingDirection>(id)) {
-      auto& facing = registry_->GetComponent<FacingDirection>(id).facing;
-      if (facing == Direction::UP) {
-        facing = Direction::DOWN;
-      } else if (facing == Direction::DOWN) {
-        facing = Direction::UP;
-      } else if (facing == Direction::LEFT) {
-        facing = Direction::RIGHT;
-      } else {
-        facing = Direction::LEFT;
-      }
-    }
-
-    // Spawn particles
-    for (int i = 0; i < 5; ++i) {
-      Position particle_pos = position;
-      Velocity particle_vel = velocity;
-      // TODO(BT-18):: use rng
-      particle_vel.x = std::copysign((rand() % 50) / 10., velocity.x);
-      particle_vel.y = std::copysign((rand() % 50) / 10., velocity.y);
-      DrawFunction draw_function{};
-      const uint8_t color = 128 + (rand() % 128);
-      draw_function.draw_fn = [color](int px, int py, olc::PixelGameEngine* engine_ptr) {
-        engine_ptr->Draw(px, py, olc::Pixel{color, color, color});
-      };
-      registry_->AddComponents(Acceleration{}, particle_vel, particle_pos, Particle{},
-                               TimeToDespawn{0.5}, draw_function);
-    }
-    // registry_->RemoveComponent(id);
+void PhysicsSystem::PhysicsStepImpl(const double delta_t) {
+  ParallelForEach<Acceleration, Velocity>(
+      *job_system_, *registry_,
+      [this, delta_t](EntityId id, const Acceleration& acceleration, Velocity& velocity) {
+        if (IsSleeping(id)) {
+          return;
+        }
+        velocity.x += acceleration.x * delta_t;
+        velocity.x = std::min(velocity.x, velocity.max_x);
+        velocity.x = std::max(velocity.x, -velocity.max_x);
+
+        velocity.y += acceleration.y * delta_t;
+        velocity.y = std::min(velocity.y, velocity.max_y);
+        velocity.y = std::max(velocity.y, -velocity.max_y);
+      });
+
+  // Actors only collide with the static level, so each one moves independently.
+  ParallelForEach<Velocity, Position, CollisionBox, Collision>(
+      *job_system_, *registry_,
+      [this, delta_t](EntityId id, Velocity& velocity, Position& position,
+                      const CollisionBox& collision_box, Collision& collisions) {
+        if (IsSleeping(id)) {
+          return;
+        }
+        Collision old_collisions = collisions;
+        collisions = {};
+
+        // Sweep each axis through the tiles on the way, then push the box out of anything it
+        // already overlapped before moving (e.g. after its collision box grew).
+        SweepAxis(Axis::X, velocity.x * delta_t, collision_box, position, velocity, collisions);
+        CheckCollisionBox(Axis::X, collision_box, position, velocity, collisions);
+
+        SweepAxis(Axis::Y, velocity.y * delta_t, collision_box, position, velocity, collisions);
+        CheckCollisionBox(Axis::Y, collision_box, position, velocity, collisions);
+
+        UpdateCollisionsChanged(collisions, old_collisions);
+      },
+      kActorGrainSize);
+
+  // Ricochets are collected per chunk and spawned afterwards on this thread, in entity order, so
+  // the registry and rand() are only touched serially.
+  const auto projectile_ids = registry_->GetView<Velocity, Position, Projectile>();
+  const auto projectiles = ResolveComponents<Velocity, Position>(*registry_, projectile_ids);
+  std::mutex ricochets_mutex;
+  job_system_->ParallelForRange(
+      0, static_cast<int>(projectile_ids.size()),
+      [&](const int begin, const int end) {
+        std::vector<Ricochet> chunk_ricochets;
+        std::vector<ProjectilePath> chunk_paths;
+        for (int i = begin; i < end; ++i) {
+          auto [velocity, position] = projectiles[i];
+          const int num_bounces = MoveParticleCheckCollision(delta_t, true, *position, *velocity,
+                                                             projectile_ids[i], &chunk_paths);
+          if (num_bounces > 0) {
+            chunk_ricochets.push_back(
+                Ricochet{projectile_ids[i], *position, *velocity, num_bounces});
+          }
+        }
+        std::lock_guard<std::mutex> lock{ricochets_mutex};
+        ricochets_.insert(ricochets_.end(), chunk_ricochets.begin(), chunk_ricochets.end());
+        projectile_paths_.insert(projectile_paths_.end(), chunk_paths.begin(), chunk_paths.end());
+      },
+      kProjectileGrainSize);
+  std::sort(ricochets_.begin(), ricochets_.end(), [](const Ricochet& lhs, const Ricochet& rhs) {
+    return lhs.projectile_id < rhs.projectile_id;
+  });
+  for (const auto& ricochet : ricochets_) {
+    FlipFacingDirection(ricochet.projectile_id);
   }
+}
 
-  for (auto id : registry_->GetView<Velocity, Position, Particle>()) {
-    MoveParticleCheckCollision(id, delta_t);
+void PhysicsSystem::FlipFacingDirection(const EntityId id) {
+  if (!registry_->HasComponent<FacingDirection>(id)) {
+    return;
+  }
+  auto& facing = registry_->GetComponent<FacingDirection>(id).facing;
+  if (facing == Direction::UP) {
+    facing = Direction::DOWN;
+  } else if (facing == Direction::DOWN) {
+    facing = Direction::UP;
+  } else if (facing == Direction::LEFT) {
+    facing = Direction::RIGHT;
+  } else {
+    facing = Direction::LEFT;
   }
 }
 
 void PhysicsSystem::ApplyGravity() {
   const auto gravity = parameter_server_->GetParameter<double>("physics/gravity");
-  for (auto id : registry_->GetView<Acceleration>()) {
-    auto [acceleration] = registry_->GetComponents<Acceleration>(id);
-    acceleration.y = -gravity;
-  }
+  ParallelForEach<Acceleration>(
+      *job_system_, *registry_,
+      [gravity](EntityId /*id*/, Acceleration& acceleration) { acceleration.y = -gravity; });
 }
 
 void PhysicsSystem::ApplyFriction(const double delta_t) {
@@ -365,34 +427,113 @@ void PhysicsSystem::SetDistanceFallen(const double delta_t) {
 }
 
 void PhysicsSystem::PhysicsStep(const double delta_t) {
-  std::unordered_map<EntityId, Collision> old_collisions;
-  for (EntityId id : registry_->GetView<Collision>()) {
-    old_collisions[id] = registry_->GetComponent<Collision>(id);
+  // All movement is swept, so one step is exact however slow the game runs.
+  projectile_paths_.clear();
+  ricochets_.clear();
+  WakeChangedEntities();
+  PhysicsStepImpl(delta_t);
+
+  // Keep each projectile's path in the order it was travelled, the chunks finish in any order.
+  std::stable_sort(projectile_paths_.begin(), projectile_paths_.end(),
+                   [](const ProjectilePath& lhs, const ProjectilePath& rhs) {
+                     return lhs.projectile_id < rhs.projectile_id;
+                   });
+
+  UpdateSleepStates();
+  UpdateBroadphase();
+}
+
+void PhysicsSystem::Wake(const EntityId id) {
+  sleeping_.erase(id);
+  auto itr = sleep_states_.find(id);
+  if (itr != sleep_states_.end()) {
+    itr->second.still_frames = 0;
   }
+}
 
-  if (delta_t > 0.05) {
-    // Collision detection will not work if the game is running very slow (<10hz).
-    // Therefore break it up into many smaller steps.
-    // NOTE: If physics is the reason it is running slow, this makes things worse.
-    const int num_steps = static_cast<int>(delta_t / 0.02);
-    const double delta_t_fraction = delta_t / num_steps;
-    for (int i = 0; i < num_steps; ++i) {
-      PhysicsStepImpl(delta_t_fraction);
+void PhysicsSystem::WakeRegion(const BoundingBox& region) {
+  for (const EntityId id : broadphase_.QueryAabb(region)) {
+    Wake(id);
+  }
+}
+
+void PhysicsSystem::WakeChangedEntities() {
+  // Anything else acting on a sleeping actor has to go through its velocity, acceleration or
+  // state.
+  std::vector<EntityId> woken;
+  for (const EntityId id : sleeping_) {
+    if (!registry_->HasComponents<Velocity, CollisionBox>(id)) {
+      woken.push_back(id);
+      continue;
+    }
+    const auto& [velocity, collision_box] =
+        registry_->GetComponentsConst<Velocity, CollisionBox>(id);
+    const auto& sleep_state = sleep_states_.at(id);
+    bool changed = velocity.x != 0 || velocity.y != 0 ||
+                   !(collision_box == sleep_state.collision_box);
+    if (registry_->HasComponent<Acceleration>(id)) {
+      changed |= registry_->GetComponentConst<Acceleration>(id).x != 0;
+    }
+    if (registry_->HasComponent<StateComponent>(id)) {
+      changed |= registry_->GetComponentConst<StateComponent>(id).state.GetState() !=
+                 sleep_state.state;
+    }
+    if (changed) {
+      woken.push_back(id);
     }
-  } else {
-    PhysicsStepImpl(delta_t);
   }
+  for (const EntityId id : woken) {
+    Wake(id);
+  }
+}
 
-  for (EntityId id : registry_->GetView<Collision>()) {
-    UpdateCollisionsChanged(registry_->GetComponent<Collision>(id), old_collisions[id]);
+void PhysicsSystem::UpdateSleepStates() {
+  const auto sleep_frames =
+      static_cast<int>(parameter_server_->GetParameter<double>("physics/sleep.frames"));
+  const auto ids = registry_->GetView<Velocity, Position, CollisionBox, Collision>();
+  for (auto itr = sleep_states_.begin(); itr != sleep_states_.end();) {
+    if (std::binary_search(ids.begin(), ids.end(), itr->first)) {
+      ++itr;
+      continue;
+    }
+    sleeping_.erase(itr->first);
+    itr = sleep_states_.erase(itr);
   }
+  if (sleep_frames <= 0) {
+    sleeping_.clear();
+  }
+
+  for (const EntityId id : ids) {
+    if (IsSleeping(id)) {
+      continue;
+    }
+    const auto& [velocity, collision_box, collisions] =
+        registry_->GetComponentsConst<Velocity, CollisionBox, Collision>(id);
+    std::optional<State> state;
+    if (registry_->HasComponent<StateComponent>(id)) {
+      state = registry_->GetComponentConst<StateComponent>(id).state.GetState();
+    }
+    bool at_rest = collisions.bottom && velocity.x == 0 && velocity.y == 0;
+    if (registry_->HasComponent<Acceleration>(id)) {
+      at_rest &= registry_->GetComponentConst<Acceleration>(id).x == 0;
+    }
 
-  UpdateOccupancyGrid();
+    auto& sleep_state = sleep_states_[id];
+    at_rest &= sleep_state.state == state && sleep_state.collision_box == collision_box;
+    sleep_state.still_frames = at_rest ? sleep_state.still_frames + 1 : 0;
+    sleep_state.state = state;
+    sleep_state.collision_box = collision_box;
+    if (sleep_frames > 0 && sleep_state.still_frames >= sleep_frames) {
+      sleeping_.insert(id);
+    }
+  }
 }
 
-void PhysicsSystem::CheckCollisionBox(EntityId id, const Axis& axis) {
-  auto [position, collision_box, collisions] =
-      registry_->GetComponents<Position, CollisionBox, Collision>(id);
+void PhysicsSystem::CheckCollisionBox(const Axis& axis,
+                                      const CollisionBox& collision_box,
+                                      Position& position,
+                                      Velocity& velocity,
+                                      Collision& collisions) const {
   const auto [lower_collision, upper_collision] = CheckAxisCollision(position, collision_box, axis);
 
   if (lower_collision && upper_collision) {
@@ -403,32 +544,25 @@ void PhysicsSystem::CheckCollisionBox(EntityId id, const Axis& axis) {
   if (!lower_collision && !upper_collision) {
     return;
   }
-  ResolveCollisions(id, axis, tile_size_, lower_collision, upper_collision);
+  ResolveCollisions(axis, tile_size_, lower_collision, upper_collision, collision_box, position,
+                    velocity, collisions);
 }
 
-void PhysicsSystem::UpdateOccupancyGrid() {
-  // TODO:: add reset to grid
-  occupancy_grid_ = Grid<EntityId>(collisions_grid_.GetWidth(), collisions_grid_.GetHeight());
-  for (const EntityId id : registry_->GetView<Position, CollisionBox>()) {
-    auto bounding_box = GetBoundingBox(id);
-    RB_CHECK(bounding_box.has_value());
-
-    int min_x = bounding_box->left;
-    int max_x = bounding_box->right;
-    int min_y = bounding_box->bottom;
-    int max_y = bounding_box->top;
-
-    min_x = std::max(0, min_x);
-    max_x = std::min(max_x, collisions_grid_.GetWidth() - 1);
-    min_y = std::max(0, min_y);
-    max_y = std::min(max_y, collisions_grid_.GetHeight() - 1);
-
-    for (int i = min_x; i <= max_x; ++i) {
-      for (int j = min_y; j <= max_y; ++j) {
-        occupancy_grid_.SetTile(i, j, id);
-      }
+void PhysicsSystem::UpdateBroadphase() {
+  const auto ids = registry_->GetView<Position, CollisionBox>();
+  for (const EntityId id : broadphase_.GetEntities()) {
+    if (!std::binary_search(ids.begin(), ids.end(), id)) {
+      broadphase_.Remove(id);
     }
   }
+  for (const EntityId id : ids) {
+    if (IsSleeping(id)) {
+      continue;
+    }
+    const auto bounding_box = GetBoundingBox(id);
+    RB_CHECK(bounding_box.has_value());
+    broadphase_.Update(id, *bounding_box);
+  }
 }
 
 std::optional<BoundingBox> PhysicsSystem::GetBoundingBox(const EntityId id) const {
@@ -449,37 +583,150 @@ std::optional<BoundingBox> PhysicsSystem::GetBoundingBox(const EntityId id) cons
   };
 }
 
-bool PhysicsSystem::PointCollidesWithEntity(const Position& point, const EntityId id) {
-  const auto bounding_box = GetBoundingBox(id);
-  if (!bounding_box.has_value()) {
-    return false;
+std::optional<RayHit> PhysicsSystem::Raycast(const Ray& ray) const {
+  const Vector2d& start = ray.start;
+  const Vector2d delta = ray.end - ray.start;
+  const auto point_at = [&](const double t) {
+    return Vector2d{start.x + delta.x * t, start.y + delta.y * t};
+  };
+
+  std::optional<RayHit> hit;
+  if (ray.hit_tiles) {
+    if (solid_tiles_.Get(FloorInt(start.x), FloorInt(start.y))) {
+      return RayHit{0., start, 0};
+    }
+    const auto crossing = FindFirstSolidCrossing(
+        start, delta, [this](const int x, const int y) { return solid_tiles_.Get(x, y); });
+    if (crossing.has_value()) {
+      hit = RayHit{crossing->t, point_at(crossing->t), 0};
+    }
+  }
+  if (!ray.hit_entities) {
+    return hit;
+  }
+
+  // Only entities in front of the tile that was hit matter.
+  const Vector2d end = point_at(hit.has_value() ? hit->t : 1.);
+  const BoundingBox ray_bounds{std::min(start.x, end.x), std::max(start.x, end.x),
+                               std::min(start.y, end.y), std::max(start.y, end.y)};
+  for (const EntityId id : broadphase_.QueryAabb(ray_bounds)) {
+    if (id == ray.ignored_id) {
+      continue;
+    }
+    const auto box = GetBoundingBox(id);
+    if (!box.has_value()) {
+      continue;
+    }
+    const auto t = IntersectSegmentAabb(start, delta, *box);
+    if (t.has_value() && (!hit.has_value() || *t < hit->t)) {
+      hit = RayHit{*t, point_at(*t), id};
+    }
+  }
+  return hit;
+}
+
+std::vector<std::optional<RayHit>> PhysicsSystem::RaycastBatch(
+    const std::vector<Ray>& rays) const {
+  std::vector<std::optional<RayHit>> hits(rays.size());
+  job_system_->ParallelForRange(
+      0, static_cast<int>(rays.size()),
+      [&](const int begin, const int end) {
+        for (int i = begin; i < end; ++i) {
+          hits[i] = Raycast(rays[i]);
+        }
+      },
+      kRayGrainSize);
+  return hits;
+}
+
+std::vector<EntityId> PhysicsSystem::QueryAabb(const BoundingBox& box) const {
+  auto ids = broadphase_.QueryAabb(box);
+  ids.erase(std::remove_if(ids.begin(), ids.end(),
+                           [&](const EntityId id) {
+                             const auto other = GetBoundingBox(id);
+                             return !other.has_value() || other->left >= box.right ||
+                                    box.left >= other->right || other->bottom >= box.top ||
+                                    box.bottom >= other->top;
+                           }),
+            ids.end());
+  return ids;
+}
+
+bool PhysicsSystem::IsAreaFree(const BoundingBox& box) const {
+  // Tiles only touching the box along one of its sides do not count.
+  const int min_column = FloorInt(box.left + kSkin);
+  const int max_column = FloorInt(box.right - kSkin);
+  for (int row = FloorInt(box.bottom + kSkin); row <= FloorInt(box.top - kSkin); ++row) {
+    if (solid_tiles_.AnyInRow(row, min_column, max_column)) {
+      return false;
+    }
   }
+  return true;
+}
 
-  return point.x >= bounding_box->left && point.x <= bounding_box->right &&
-         point.y >= bounding_box->bottom && point.y <= bounding_box->top;
+std::optional<EntityId> PhysicsSystem::NearestEntity(const Vector2d& point,
+                                                     const double radius,
+                                                     const EntityId ignored_id) const {
+  const BoundingBox search_box{point.x - radius, point.x + radius, point.y - radius,
+                               point.y + radius};
+  std::optional<EntityId> nearest;
+  double nearest_distance = radius;
+  for (const EntityId id : broadphase_.QueryAabb(search_box)) {
+    const auto box = GetBoundingBox(id);
+    if (id == ignored_id || !box.has_value()) {
+      continue;
+    }
+    // Zero inside the box.
+    const double dx = std::max({box->left - point.x, 0., point.x - box->right});
+    const double dy = std::max({box->bottom - point.y, 0., point.y - box->top});
+    const double distance = std::hypot(dx, dy);
+    if (distance < nearest_distance || (!nearest.has_value() && distance == nearest_distance)) {
+      nearest = id;
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
 }
 
 std::vector<CollisionEvent> PhysicsSystem::DetectProjectileCollisions() {
+  // Test the whole path travelled during the last step, so fast projectiles do not pass through
+  // thin actors. A projectile hits the first actor along its path other than its shooter, whose
+  // box the muzzle is often inside of.
   std::vector<CollisionEvent> events;
-  for (const EntityId id : registry_->GetView<Position, Projectile>()) {
-    const auto& position = registry_->GetComponentConst<Position>(id);
-    const int pos_x = static_cast<int>(std::floor(position.x));
-    const int pos_y = static_cast<int>(std::floor(position.y));
-    if (!occupancy_grid_.ValidCoord(pos_x, pos_y)) {
+  std::vector<EntityId> candidates;
+  EntityId last_hit_projectile{0};
+  for (const auto& [projectile_id, start, end] : projectile_paths_) {
+    if (projectile_id == last_hit_projectile) {
       continue;
     }
-    const EntityId other_id = occupancy_grid_.GetTile(pos_x, pos_y);
-    if (other_id == 0) {
-      continue;
+    const Vector2d delta = end - start;
+    const BoundingBox path_bounds{std::min(start.x, end.x), std::max(start.x, end.x),
+                                  std::min(start.y, end.y), std::max(start.y, end.y)};
+    broadphase_.QueryAabb(path_bounds, candidates);
+    const EntityId shooter_id = registry_->GetComponentConst<Projectile>(projectile_id).shooter_id;
+
+    std::optional<double> first_hit_t;
+    EntityId first_hit_id{0};
+    for (const EntityId other_id : candidates) {
+      if (other_id == shooter_id) {
+        continue;
+      }
+      const auto bounding_box = GetBoundingBox(other_id);
+      if (!bounding_box.has_value()) {
+        continue;
+      }
+      const auto t = IntersectSegmentAabb(start, delta, *bounding_box);
+      if (t.has_value() && (!first_hit_t.has_value() || *t < *first_hit_t)) {
+        first_hit_t = t;
+        first_hit_id = other_id;
+      }
     }
-
-    // LOG_INFO(id << ":\t potential Collision with " << other_id);
-    if (PointCollidesWithEntity(position, other_id)) {
-      events.emplace_back(CollisionEvent{other_id, id});
-      // LOG_INFO(id << ":\t Collision with " << other_id);
+    if (first_hit_t.has_value()) {
+      events.emplace_back(CollisionEvent{first_hit_id, projectile_id});
+      last_hit_projectile = projectile_id;
     }
   }
   return events;
 }
 
-}  // namespace platformer
\ No newline at end of file
+}  // namespace platformer
@@ -2,19 +2,24 @@
 
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "common_types/basic_types.h"
+#include "common_types/bit_grid.h"
 #include "common_types/components.h"
+#include "common_types/distance_field.h"
 #include "common_types/entity.h"
 #include "common_types/game_configuration.h"
+#include "common_types/spatial_hash.h"
 #include "registry.h"
 #include "registry_helpers.h"
+#include "utils/job_system.h"
 #include "utils/parameter_server.h"
 
 namespace platformer {
 
 enum class Side : std::uint8_t { LEFT, RIGHT, TOP, BOTTOM };
-enum class Axis : std::uint8_t { X, Y };
 
 struct AxisCollisions {
   bool lower_collision{false};
@@ -28,10 +33,34 @@ struct CollisionEvent {
   EntityId projectile_id;
 };
 
+// A projectile that bounced off the level, where it ended up after the step.
+struct Ricochet {
+  EntityId projectile_id;
+  Position position;
+  Velocity velocity;
+  int num_bounces{1};  // Within the step.
+};
+
+// A segment from start to end, in tiles.
+struct Ray {
+  Vector2d start;
+  Vector2d end;
+  EntityId ignored_id{};  // E.g. the shooter. Zero ignores nothing.
+  bool hit_tiles{true};
+  bool hit_entities{true};
+};
+
+struct RayHit {
+  double t;  // Fraction of the ray travelled, in [0, 1].
+  Vector2d point;
+  EntityId entity_id{};  // Zero for a solid tile.
+};
+
 class PhysicsSystem {
  public:
   PhysicsSystem(const Level& level,
                 std::shared_ptr<ParameterServer> parameter_server,
+                std::shared_ptr<JobSystem> job_system,
                 std::shared_ptr<Registry> registry);
 
   void PhysicsStep(double delta_t);
@@ -44,26 +73,96 @@ class PhysicsSystem {
                                                   const CollisionBox& bounding_box,
                                                   Axis axis) const;
 
-  const Grid<EntityId>& GetOccupancyGrid() { return occupancy_grid_; }
+  // Bounding boxes of all entities with a collision box, as of the last physics step.
+  const SpatialHash& GetBroadphase() const { return broadphase_; }
+
+  // Queries against the solid tiles and the bounding boxes of entities with a collision box, as
+  // of the last physics step. Safe to call concurrently with each other, but not with a step.
+  //
+  // The first solid tile or entity box along the ray. Rays starting inside one hit at t = 0.
+  [[nodiscard]] std::optional<RayHit> Raycast(const Ray& ray) const;
+  // As Raycast, for many rays at once, spread over the job system.
+  [[nodiscard]] std::vector<std::optional<RayHit>> RaycastBatch(const std::vector<Ray>& rays) const;
+  // Entities whose boxes overlap the box. Sorted.
+  [[nodiscard]] std::vector<EntityId> QueryAabb(const BoundingBox& box) const;
+  // Whether the box is clear of solid tiles.
+  [[nodiscard]] bool IsAreaFree(const BoundingBox& box) const;
+  // The entity whose box is closest to the point, within the radius.
+  [[nodiscard]] std::optional<EntityId> NearestEntity(const Vector2d& point,
+                                                      double radius,
+                                                      EntityId ignored_id = 0) const;
+  [[nodiscard]] std::optional<BoundingBox> GetBoundingBox(EntityId id) const;
+
+  // Projectiles that bounced during the last step, sorted by projectile id.
+  const std::vector<Ricochet>& GetRicochets() const { return ricochets_; }
+  // Distance from each tile to the nearest solid tile, for proximity and line of sight queries.
+  const DistanceField& GetDistanceField() const { return distance_field_; }
+
+  // Actors resting on the ground for "physics/sleep.frames" steps fall asleep: they are skipped
+  // by the integration, collision and broadphase updates until their velocity, acceleration,
+  // state or collision box changes, or they are woken explicitly.
+  [[nodiscard]] bool IsSleeping(EntityId id) const {
+    return !sleeping_.empty() && sleeping_.count(id) != 0;
+  }
+  [[nodiscard]] int GetNumSleeping() const { return static_cast<int>(sleeping_.size()); }
+  void Wake(EntityId id);
+  // Wakes every entity overlapping the region, e.g. after the level geometry there changed.
+  void WakeRegion(const BoundingBox& region);
 
  private:
-  std::vector<Axis> MoveParticleCheckCollision(const EntityId id, const double delta_t);
+  // What an actor looked like during the previous step, to tell whether it is at rest.
+  struct SleepState {
+    int still_frames{};
+    std::optional<State> state;
+    CollisionBox collision_box{};
+  };
+
+  // A straight piece of a projectile's path during the last step.
+  struct ProjectilePath {
+    EntityId projectile_id;
+    Vector2d start;
+    Vector2d end;
+  };
+
+  // Moves a point along its velocity for delta_t without passing through solid tiles. It either
+  // bounces off them or stops at the first one. Returns the number of bounces.
+  // The straight pieces travelled are appended to path, if given.
+  int MoveParticleCheckCollision(double delta_t,
+                                 bool bounce,
+                                 Position& position,
+                                 Velocity& velocity,
+                                 EntityId id,
+                                 std::vector<ProjectilePath>* path) const;
   void PhysicsStepImpl(double delta_t);
-  void CheckCollisionBox(EntityId id, const Axis& axis);
-  void ResolveCollisions(EntityId id,
-                         const Axis& axis,
-                         int tile_size,
-                         bool lower_collision,
-                         bool upper_collision);
-  std::optional<BoundingBox> GetBoundingBox(const EntityId id) const;
-  bool PointCollidesWithEntity(const Position& point, const EntityId id);
+  void FlipFacingDirection(EntityId id);
+  // Moves the box `distance` tiles along the axis, stopping in front of the first solid tile its
+  // leading edge would enter.
+  void SweepAxis(Axis axis,
+                 double distance,
+                 const CollisionBox& collision_box,
+                 Position& position,
+                 Velocity& velocity,
+                 Collision& collisions) const;
+  void CheckCollisionBox(const Axis& axis,
+                         const CollisionBox& collision_box,
+                         Position& position,
+                         Velocity& velocity,
+                         Collision& collisions) const;
 
-  void UpdateOccupancyGrid();
+  void UpdateBroadphase();
+  void WakeChangedEntities();
+  void UpdateSleepStates();
 
   int tile_size_;
-  Grid<int> collisions_grid_;
-  Grid<EntityId> occupancy_grid_;
+  BitGrid solid_tiles_;
+  DistanceField distance_field_;
+  SpatialHash broadphase_;
+  std::vector<ProjectilePath> projectile_paths_;  // Sorted by projectile id.
+  std::vector<Ricochet> ricochets_;
+  std::unordered_map<EntityId, SleepState> sleep_states_;
+  std::unordered_set<EntityId> sleeping_;
   std::shared_ptr<ParameterServer> parameter_server_;
+  std::shared_ptr<JobSystem> job_system_;
   std::shared_ptr<Registry> registry_;
 };
 
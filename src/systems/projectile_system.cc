@@ -1,5 +1,8 @@
 #include "projectile_system.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "common_types/components.h"
 #include "common_types/entity.h"
 
@@ -8,17 +11,25 @@ namespace platformer {
 constexpr double kShotgunProjectileVelocity = 30.0;
 constexpr double kShotgunNumPellets = 25.0;  // TODO(BT-01): parameter server type support
 constexpr double kRifleProjectileVelocity = 30.0;
+constexpr double kMaxProjectileBounces = 3.0;
+constexpr double kMaxProjectileAge = 3.0;
+constexpr double kMaxLiveProjectiles = 500.0;
+
+// How far in front of a wall a bullet spawns if the gun pokes into it. Unit: tiles.
+constexpr double kWallSpawnGap = 1e-3;
 
 ProjectileSystem::ProjectileSystem(std::shared_ptr<ParameterServer> parameter_server,
                                    std::shared_ptr<const SpriteManager> animation_manager,
                                    std::shared_ptr<const RandomNumberGenerator> rng,
                                    std::shared_ptr<Registry> registry,
-                                   int tile_size)
+                                   const Level& level)
     : parameter_server_{std::move(parameter_server)},
       animation_manager_{std::move(animation_manager)},
       rng_{std::move(rng)},
       registry_{std::move(registry)},
-      tile_size_{tile_size} {
+      tile_size_{level.level_tileset->GetTileSize()},
+      level_width_{level.property_grid.GetWidth()},
+      level_height_{level.property_grid.GetHeight()} {
   parameter_server_->AddParameter("projectiles/shotgun.vel", kShotgunProjectileVelocity,
                                   "How fast the bullets go. Unit: tile/s");
 
@@ -27,9 +38,19 @@ ProjectileSystem::ProjectileSystem(std::shared_ptr<ParameterServer> parameter_se
 
   parameter_server_->AddParameter("projectiles/rifle.vel", kRifleProjectileVelocity,
                                   "How fast the bullet goes. Unit: tile/s");
+
+  parameter_server_->AddParameter("projectiles/max.bounces", kMaxProjectileBounces,
+                                  "Projectiles are removed after bouncing this many times.");
+
+  parameter_server_->AddParameter("projectiles/max.age", kMaxProjectileAge,
+                                  "Projectiles are removed after this long. Unit: s");
+
+  parameter_server_->AddParameter("projectiles/max.live", kMaxLiveProjectiles,
+                                  "Maximum number of projectiles, the oldest ones are removed.");
 }
 
-Vector2d ProjectileSystem::GetBulletSpawnLocation(const EntityId entity_id) const {
+Vector2d ProjectileSystem::GetBulletSpawnLocation(const EntityId entity_id,
+                                                  const PhysicsSystem& physics) const {
   auto [facing, position] = registry_->GetComponentsConst<FacingDirection, Position>(entity_id);
   const auto spawn_location = animation_manager_->GetInsideSpriteLocation(entity_id);
   RB_CHECK(spawn_location.has_value());
@@ -41,7 +62,21 @@ Vector2d ProjectileSystem::GetBulletSpawnLocation(const EntityId entity_id) cons
   const double tile_size_f = tile_size_;
   const double x_location = position.x + (sprite_width / 2 + sign * x_from_center) / tile_size_f;
   const double y_location = position.y + (spawn_location->y_px) / tile_size_f;
-  return {x_location, y_location};
+  const Vector2d gun_location{x_location, y_location};
+
+  // The gun can stick out of the collision box, e.g. into a wall the player is standing against.
+  const auto box = physics.GetBoundingBox(entity_id);
+  if (!box.has_value()) {
+    return gun_location;
+  }
+  const Vector2d center{(box->left + box->right) / 2, (box->bottom + box->top) / 2};
+  const auto hit = physics.Raycast(Ray{center, gun_location, entity_id, true, false});
+  if (!hit.has_value()) {
+    return gun_location;
+  }
+  const double t = std::max(0., hit->t - kWallSpawnGap / std::hypot(gun_location.x - center.x,
+                                                                    gun_location.y - center.y));
+  return {center.x + (gun_location.x - center.x) * t, center.y + (gun_location.y - center.y) * t};
 }
 
 Velocity ProjectileSystem::GetShotgunPelletVelocity(const State state,
@@ -92,32 +127,25 @@ Velocity ProjectileSystem::GetRifleBulletVelocity(const EntityId id) const {
   return vel;
 }
 
-void ProjectileSystem::SpawnShotgunProjectiles(const EntityId entity_id) {
+void ProjectileSystem::SpawnShotgunProjectiles(const EntityId entity_id,
+                                               const Vector2d& spawn_location) {
   const auto& state = registry_->GetComponent<StateComponent>(entity_id).state.GetState();
   const auto& facing_direction = registry_->GetComponent<FacingDirection>(entity_id).facing;
   // TODO(BT-01): Parameter server more type support
   const int num_pellets =
       static_cast<int>(parameter_server_->GetParameter<double>("projectiles/num_shotgun_pellets"));
+  const auto max_age = parameter_server_->GetParameter<double>("projectiles/max.age");
   for (int i = 0; i < num_pellets; ++i) {
-    const auto pos = GetBulletSpawnLocation(entity_id);
-
-    DrawFunction draw_function{};
-    draw_function.draw_fn = [](int px, int py, olc::PixelGameEngine* engine_ptr) {
-      engine_ptr->Draw(px, py, olc::WHITE);
-      engine_ptr->Draw(px + 1, py, olc::WHITE);
-      engine_ptr->Draw(px, py + 1, olc::WHITE);
-      engine_ptr->Draw(px - 1, py, olc::WHITE);
-      engine_ptr->Draw(px, py - 1, olc::WHITE);
-    };
-
-    registry_->AddComponents(Position{pos.x, pos.y},
+    registry_->AddComponents(Position{spawn_location.x, spawn_location.y},
                              GetShotgunPelletVelocity(state, facing_direction),
-                             SpriteComponent{"pellet"}, draw_function, Projectile{});
+                             PrimitiveComponent{Rgba{255, 255, 255}, PrimitiveShape::kPlus},
+                             Projectile{0, entity_id},
+                             TimeToDespawn{max_age});
   }
 }
 
-void ProjectileSystem::SpawnRifleProjectile(const EntityId entity_id) {
-  const auto pos = GetBulletSpawnLocation(entity_id);
+void ProjectileSystem::SpawnRifleProjectile(const EntityId entity_id,
+                                            const Vector2d& spawn_location) {
   const auto vel = GetRifleBulletVelocity(entity_id);
 
   std::string key{"bullet_01"};
@@ -129,22 +157,59 @@ void ProjectileSystem::SpawnRifleProjectile(const EntityId entity_id) {
     facing.facing = vel.y > 0 ? Direction::UP : Direction::DOWN;
   }
 
-  registry_->AddComponents(Position{pos.x, pos.y}, vel,
+  registry_->AddComponents(Position{spawn_location.x, spawn_location.y}, vel,
                            AnimatedSpriteComponent{GameClock::NowGlobal(), {}, key}, facing,
-                           Projectile{});
+                           Projectile{0, entity_id},
+                           TimeToDespawn{parameter_server_->GetParameter<double>(
+                               "projectiles/max.age")});
 }
 
-void ProjectileSystem::SpawnProjectiles(const std::vector<AnimationEvent>& animation_events) {
+void ProjectileSystem::SpawnProjectiles(const std::vector<AnimationEvent>& animation_events,
+                                        const PhysicsSystem& physics) {
   for (const auto& event : animation_events) {
     if (event.event_name == "PlayerShoot") {
       const auto& weapon = registry_->GetComponent<PlayerComponent>(event.entity_id).weapon;
+      const auto spawn_location = GetBulletSpawnLocation(event.entity_id, physics);
       if (weapon == Weapon::Rifle) {
-        SpawnRifleProjectile(event.entity_id);
+        SpawnRifleProjectile(event.entity_id, spawn_location);
       } else if (weapon == Weapon::Shotgun) {
-        SpawnShotgunProjectiles(event.entity_id);
+        SpawnShotgunProjectiles(event.entity_id, spawn_location);
       }
     }
   }
 }
 
+void ProjectileSystem::RemoveExpiredProjectiles(const std::vector<Ricochet>& ricochets) {
+  const auto max_bounces =
+      static_cast<int>(parameter_server_->GetParameter<double>("projectiles/max.bounces"));
+  for (const auto& ricochet : ricochets) {
+    if (!registry_->HasComponent<Projectile>(ricochet.projectile_id)) {
+      continue;
+    }
+    auto& projectile = registry_->GetComponent<Projectile>(ricochet.projectile_id);
+    projectile.num_bounces += ricochet.num_bounces;
+    if (projectile.num_bounces >= max_bounces) {
+      registry_->RemoveComponent(ricochet.projectile_id);
+    }
+  }
+
+  // Ids are handed out in increasing order, so the oldest projectiles come first.
+  std::vector<EntityId> live_ids;
+  for (const EntityId id : registry_->GetView<Position, Projectile>()) {
+    const auto& position = registry_->GetComponentConst<Position>(id);
+    if (position.x < 0 || position.y < 0 || position.x > level_width_ ||
+        position.y > level_height_) {
+      registry_->RemoveComponent(id);
+    } else {
+      live_ids.push_back(id);
+    }
+  }
+
+  const auto max_live =
+      static_cast<size_t>(parameter_server_->GetParameter<double>("projectiles/max.live"));
+  for (size_t i = 0; i + max_live < live_ids.size(); ++i) {
+    registry_->RemoveComponent(live_ids[i]);
+  }
+}
+
 }  // namespace platformer
\ No newline at end of file
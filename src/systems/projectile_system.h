@@ -4,6 +4,8 @@
 
 #include "animation/sprite_manager.h"
 #include "common_types/entity.h"
+#include "common_types/game_configuration.h"
+#include "systems/physics_system.h"
 #include "utils/parameter_server.h"
 #include "utils/random_number_generator.h"
 #include "registry.h"
@@ -16,15 +18,22 @@ class ProjectileSystem {
                      std::shared_ptr<const SpriteManager> animation_manager,
                      std::shared_ptr<const RandomNumberGenerator> rng,
                      std::shared_ptr<Registry> registry,
-                     int tile_size);
+                     const Level& level);
 
-    void SpawnProjectiles(const std::vector<AnimationEvent>& animation_events);
+    // Bullets spawn in front of the gun, or just short of the wall the gun is poking into.
+    void SpawnProjectiles(const std::vector<AnimationEvent>& animation_events,
+                          const PhysicsSystem& physics);
+
+    // Removes projectiles that bounced "projectiles/max.bounces" times, left the level, or,
+    // oldest first, exceed "projectiles/max.live". Projectiles also despawn after
+    // "projectiles/max.age" seconds. This keeps the number of live projectiles bounded.
+    void RemoveExpiredProjectiles(const std::vector<Ricochet>& ricochets);
 
   private:
-    void SpawnShotgunProjectiles(const EntityId entity_id);
-    void SpawnRifleProjectile(const EntityId entity_id);
+    void SpawnShotgunProjectiles(const EntityId entity_id, const Vector2d& spawn_location);
+    void SpawnRifleProjectile(const EntityId entity_id, const Vector2d& spawn_location);
 
-    Vector2d GetBulletSpawnLocation(const EntityId entity_id) const;
+    Vector2d GetBulletSpawnLocation(const EntityId entity_id, const PhysicsSystem& physics) const;
     Velocity GetShotgunPelletVelocity(const State state,
                                       const Direction facing_direction) const;
     Velocity GetRifleBulletVelocity(EntityId id) const; //const State state,
@@ -35,6 +44,8 @@ class ProjectileSystem {
     std::shared_ptr<const RandomNumberGenerator> rng_;
     std::shared_ptr<Registry> registry_;
     int tile_size_;
+    int level_width_;   // In tiles.
+    int level_height_;  // In tiles.
 };
 
 }
\ No newline at end of file
@@ -22,15 +22,38 @@ constexpr double kFollowPlayerScreenRatioY = 0.5;
 
 constexpr double kDrawPlayerCollisions = 0.0;  // TODO(BT-01)::Bool
 
+// 16x16 tiles per chunk, a 640x360 screen shows at most 12 of them with 16 pixel tiles. The cache
+// grows to a full screen of chunks for smaller tiles.
+constexpr int kTileChunkSize = 16;
+constexpr int kMaxCachedTileChunks = 32;
+
+// Slack for culling entities, in pixels. Primitives and collision boxes reach up to a pixel
+// outside of the entity's sprite.
+constexpr int kCullMarginPx = 2;
+
+constexpr double kBandedRendering = 0.0;  // TODO(BT-01)::Bool
+// More bands than threads, as the bands are far from equally expensive: most tiles and entities
+// are in the bottom half of the screen.
+constexpr int kBandsPerThread = 2;
+
+constexpr double kDamageTracking = 0.0;  // TODO(BT-01)::Bool
+
+// The effects layer is drawn in two batches: the particles, then the primitives of entities, e.g.
+// pellets, on top of them.
+constexpr int kParticlesSortKey = 0;
+constexpr int kEntityPrimitivesSortKey = 1;
+
 namespace {
-olc::Sprite::Flip GetFlip(EntityId id, const Registry& registry) {
-  if (!registry.HasComponent<FacingDirection>(id)) {
+// Entities are stacked in the order they were created, whatever image they are showing.
+int GetSortKey(const RenderEntity& entity) { return static_cast<int>(entity.id); }
+
+olc::Sprite::Flip GetFlip(const std::optional<Direction>& facing) {
+  if (!facing.has_value()) {
     return olc::Sprite::Flip::NONE;
   }
   // From olc:
   // 		enum Flip { NONE = 0, HORIZ = 1, VERT = 2 };
   // This is a bitmask.
-  const auto facing = registry.GetComponent<FacingDirection>(id).facing;
   if (facing == Direction::LEFT) {
     return olc::Sprite::Flip::HORIZ;
   }
@@ -40,18 +63,43 @@ olc::Sprite::Flip GetFlip(EntityId id, const Registry& registry) {
   return olc::Sprite::Flip::NONE;
 }
 
+// Points the engine's draw target at another sprite for the lifetime of the object.
+class ScopedEngineDrawTarget {
+ public:
+  ScopedEngineDrawTarget(olc::PixelGameEngine* engine_ptr, olc::Sprite* target)
+      : engine_ptr_{engine_ptr}, previous_target_{engine_ptr->GetDrawTarget()} {
+    engine_ptr_->SetDrawTarget(target);
+  }
+  ~ScopedEngineDrawTarget() {
+    // An engine without a window has no draw target of its own to go back to.
+    if (previous_target_ != nullptr) {
+      engine_ptr_->SetDrawTarget(previous_target_);
+    }
+  }
+  ScopedEngineDrawTarget(const ScopedEngineDrawTarget&) = delete;
+  ScopedEngineDrawTarget& operator=(const ScopedEngineDrawTarget&) = delete;
+
+ private:
+  olc::PixelGameEngine* engine_ptr_;
+  olc::Sprite* previous_target_;
+};
+
 }  // namespace
 
 RenderingSystem::RenderingSystem(olc::PixelGameEngine* engine_ptr,
                                  Level level,
                                  std::shared_ptr<ParameterServer> parameter_server,
                                  std::shared_ptr<SpriteManager> animation_manager,
-                                 std::shared_ptr<Registry> registry)
+                                 std::shared_ptr<Registry> registry,
+                                 std::shared_ptr<JobSystem> job_system)
     : engine_ptr_{engine_ptr},
       level_{std::move(level)},
       parameter_server_{std::move(parameter_server)},
       animation_manager_{std::move(animation_manager)},
-      registry_{std::move(registry)} {
+      registry_{std::move(registry)},
+      job_system_{std::move(job_system)},
+      tile_chunks_{level_, kTileChunkSize, kMaxCachedTileChunks, kScreenWidthPx,
+                   kScreenHeightPx} {
   parameter_server_->AddParameter(
       "rendering/follow.player.screen.ratio.x", kFollowPlayerScreenRatioX,
       "How far the player can walk towards the side of the screen before the camera follows, as a "
@@ -66,6 +114,15 @@ RenderingSystem::RenderingSystem(olc::PixelGameEngine* engine_ptr,
   parameter_server_->AddParameter("viz/draw.player.collisions", kDrawPlayerCollisions,
                                   "Visualize collisions of the player");
 
+  parameter_server_->AddParameter(
+      "threading/banded.rendering", kBandedRendering,
+      "If 1, record the draws of each frame, then rasterize horizontal bands of the screen in "
+      "parallel on the job system.");
+  parameter_server_->AddParameter(
+      "rendering/damage.tracking", kDamageTracking,
+      "If 1, only redraw the rows of the screen that changed since the previous frame. The whole "
+      "screen is still redrawn whenever the camera moves.");
+
   const int grid_width = level_.tile_grid.GetWidth();
   const int grid_height = level_.tile_grid.GetHeight();
 
@@ -134,7 +191,10 @@ bool RenderingSystem::AddBackgroundLayer(const std::filesystem::path& background
     std::cout << "Failed loading background image '" << background_png << "'" << std::endl;
     return false;
   }
+  layer.spans = SpriteSpans{*layer.background_img};
   background_layers_.emplace_back(std::move(layer));
+  UpdateBackgroundComposite();
+  last_frame_tracked_ = false;
   return true;
 }
 
@@ -147,118 +207,213 @@ bool RenderingSystem::AddForegroundLayer(const std::filesystem::path& background
     std::cout << "Failed loading background image '" << background_png << "'" << std::endl;
     return false;
   }
+  layer.spans = SpriteSpans{*layer.background_img};
   foreground_layers_.emplace_back(std::move(layer));
+  last_frame_tracked_ = false;
   return true;
 }
 
 void RenderingSystem::AddFoundationBackgroundLayer(uint8_t r, uint8_t g, uint8_t b) {
   foundation_background_color_ = olc::Pixel{r, g, b, 255};
+  UpdateBackgroundComposite();
+  last_frame_tracked_ = false;
 }
 
-void RenderingSystem::RenderBackground() {
-  if (foundation_background_color_.has_value()) {
-    for (int y = 0; y < kScreenHeightPx; ++y) {
-      for (int x = 0; x < kScreenWidthPx; ++x) {
-        engine_ptr_->Draw(x, y, *foundation_background_color_);
-      }
+void RenderingSystem::UpdateBackgroundComposite() {
+  background_composite_.reset();
+  num_composited_layers_ = 0;
+  if (background_layers_.empty()) {
+    return;
+  }
+  // Blending onto a transparent composite would not give the same colors as blending onto the
+  // screen.
+  const auto& bottom = background_layers_.front();
+  if (!foundation_background_color_.has_value() &&
+      bottom.spans.GetOpacity() != SpriteOpacity::kOpaque) {
+    return;
+  }
+
+  background_composite_ =
+      std::make_unique<olc::Sprite>(bottom.background_img->width, bottom.background_img->height);
+  std::fill(background_composite_->pColData.begin(), background_composite_->pColData.end(),
+            foundation_background_color_.value_or(olc::BLANK));
+  for (const auto& layer : background_layers_) {
+    if (layer.background_img->width != bottom.background_img->width ||
+        layer.background_img->height != bottom.background_img->height ||
+        layer.scroll_slowdown_factor != bottom.scroll_slowdown_factor) {
+      break;
     }
+    DrawSpans(*layer.background_img, layer.spans, 0, 0, olc::Sprite::Flip::NONE,
+              *background_composite_);
+    ++num_composited_layers_;
   }
+}
+
+void RenderingSystem::SetRenderTarget(olc::Sprite* target) { render_target_ = target; }
+
+olc::Sprite& RenderingSystem::GetRenderTarget() const {
+  olc::Sprite* target = render_target_ != nullptr ? render_target_ : engine_ptr_->GetDrawTarget();
+  RB_CHECK(target != nullptr);
+  return *target;
+}
 
-  for (const auto& background_layer : background_layers_) {
-    RenderBackgroundLayer(background_layer);
+void RenderingSystem::RenderFrame(const RenderSnapshot& snapshot) {
+  SubmitBackground();
+  SubmitTiles();
+  SubmitEntities(snapshot);
+  SubmitForeground();
+  if (parameter_server_->GetParameter<double>("rendering/damage.tracking") > 0) {
+    RasterizeDamage();
+  } else {
+    Rasterize();
   }
 }
 
+void RenderingSystem::RenderBackground() {
+  SubmitBackground();
+  Rasterize();
+}
+
 void RenderingSystem::RenderForeground() {
+  SubmitForeground();
+  Rasterize();
+}
+
+void RenderingSystem::RenderTiles() {
+  SubmitTiles();
+  Rasterize();
+}
+
+void RenderingSystem::Rasterize() {
+  commands_.Clear();
+  render_queue_.Flush(commands_);
+  ReplayCommands(GetRenderTarget());
+  last_frame_tracked_ = false;
+}
+
+void RenderingSystem::RasterizeDamage() {
+  commands_.Clear();
+  const bool damage_known = render_queue_.FlushDamage(commands_, damaged_rows_);
+  olc::Sprite& target = GetRenderTarget();
+  // Everything on screen moves with the camera.
+  const bool redraw_all = !damage_known || !last_frame_tracked_ ||
+                          last_frame_target_ != &target ||
+                          last_frame_cam_px_x_ != cam_position_px_x_ ||
+                          last_frame_cam_px_y_ != cam_position_px_y_;
+  if (redraw_all) {
+    ReplayCommands(target);
+  } else {
+    for (const auto rows : damaged_rows_) {
+      commands_.Replay(target, rows);
+    }
+  }
+  last_frame_tracked_ = true;
+  last_frame_target_ = &target;
+  last_frame_cam_px_x_ = cam_position_px_x_;
+  last_frame_cam_px_y_ = cam_position_px_y_;
+}
+
+void RenderingSystem::ReplayCommands(olc::Sprite& target) {
+  if (parameter_server_->GetParameter<double>("threading/banded.rendering") > 0) {
+    commands_.ReplayBanded(target, kBandsPerThread * job_system_->GetConcurrency(), *job_system_);
+  } else {
+    commands_.Replay(target);
+  }
+}
+
+void RenderingSystem::SubmitBackground() {
+  if (background_composite_ == nullptr) {
+    if (foundation_background_color_.has_value()) {
+      render_queue_.SubmitRect(RenderLayer::kBackground, 0, 0, 0, kScreenWidthPx, kScreenHeightPx,
+                               *foundation_background_color_);
+    }
+    for (const auto& background_layer : background_layers_) {
+      SubmitBackgroundLayer(background_layer, RenderLayer::kBackground);
+    }
+    return;
+  }
+
+  const auto& composite = *background_composite_;
+  const auto placement =
+      GetLayerPlacement(composite, background_layers_.front().scroll_slowdown_factor);
+  const bool covers_screen = placement.x <= 0 && placement.y <= 0 &&
+                             placement.x + placement.num_x * composite.width >= kScreenWidthPx &&
+                             placement.y + placement.num_y * composite.height >= kScreenHeightPx;
+  if (foundation_background_color_.has_value() && !covers_screen) {
+    render_queue_.SubmitRect(RenderLayer::kBackground, 0, 0, 0, kScreenWidthPx, kScreenHeightPx,
+                             *foundation_background_color_);
+  }
+  render_queue_.SubmitRepeatedImage(RenderLayer::kBackground, 0, composite, placement.x,
+                                    placement.y, placement.num_x, placement.num_y);
+  for (size_t i = num_composited_layers_; i < background_layers_.size(); ++i) {
+    SubmitBackgroundLayer(background_layers_[i], RenderLayer::kBackground);
+  }
+}
+
+void RenderingSystem::SubmitForeground() {
   for (const auto& background_layer : foreground_layers_) {
-    RenderBackgroundLayer(background_layer);
+    SubmitBackgroundLayer(background_layer, RenderLayer::kForeground);
   }
 }
 
-void RenderingSystem::RenderBackgroundLayer(const BackgroundLayer& background_layer) {
-  const double scroll_factor = background_layer.scroll_slowdown_factor;
-  const auto& background = background_layer.background_img;
+void RenderingSystem::SubmitBackgroundLayer(const BackgroundLayer& background_layer,
+                                            const RenderLayer layer) {
+  const auto& background = *background_layer.background_img;
+  const olc::Pixel* pixels = background_layer.background_img->GetData();
+  const auto placement = GetLayerPlacement(background, background_layer.scroll_slowdown_factor);
+  for (int i = 0; i < placement.num_y; ++i) {
+    for (int j = 0; j < placement.num_x; ++j) {
+      render_queue_.SubmitSprite(layer, 0, pixels, background_layer.spans,
+                                 placement.x + j * background.width,
+                                 placement.y + i * background.height, olc::Sprite::Flip::NONE);
+    }
+  }
+}
 
+RenderingSystem::LayerPlacement RenderingSystem::GetLayerPlacement(
+    const olc::Sprite& image, const double scroll_slowdown_factor) const {
+  // The number of copies from start on needed to reach the end of the screen.
+  const auto num_copies = [](const int start, const int size, const int screen_size) {
+    return start < screen_size ? (screen_size - start + size - 1) / size : 0;
+  };
   const auto total_height_pixels =
       level_.tile_grid.GetHeight() * level_.level_tileset->GetTileSize();
 
-  int num_of_background_draws{};
+  LayerPlacement placement{};
+  placement.x = -(static_cast<int>(cam_position_px_x_ / scroll_slowdown_factor) % image.width);
+  placement.num_x = num_copies(placement.x, image.width, kScreenWidthPx);
   // If the background is taller than the screensize, linearly move the camera such that you see the
   // top of the background at the top of the level, and the bottom at the bottom.
-  if (background->height > kScreenHeightPx) {
+  if (image.height > kScreenHeightPx) {
     // C++ 20
-    // auto y_pos = std::lerp(-background->height + kScreenHeightPx, 0.0,
+    // auto y_pos = std::lerp(-image.height + kScreenHeightPx, 0.0,
     //  cam_position_px_y_ / (total_height_pixels - kScreenHeightPx));
 
-    const double y_multiplier = static_cast<double>(background->height - kScreenHeightPx) /
+    const double y_multiplier = static_cast<double>(image.height - kScreenHeightPx) /
                                 static_cast<double>(total_height_pixels - kScreenHeightPx);
-    auto y_pos =
-        static_cast<int>(y_multiplier * cam_position_px_y_ - background->height + kScreenHeightPx);
-    auto x_pos = -(static_cast<int>(cam_position_px_x_ / scroll_factor) % background->width);
-    while (x_pos < kScreenWidthPx) {
-      num_of_background_draws++;
-      engine_ptr_->DrawSprite(x_pos, y_pos, background.get());
-      x_pos += background->width;
-    }
+    placement.y =
+        static_cast<int>(y_multiplier * cam_position_px_y_ - image.height + kScreenHeightPx);
+    placement.num_y = 1;
   } else {
     // If y is smaller than the screen size, tile both the same way.
-    auto y_pos = (static_cast<int>((cam_position_px_y_ / scroll_factor) - kScreenHeightPx) %
-                  background->height);
-    while (y_pos < kScreenHeightPx) {
-      auto x_pos = -(static_cast<int>(cam_position_px_x_ / scroll_factor) % background->width);
-      while (x_pos < kScreenWidthPx) {
-        num_of_background_draws++;
-        engine_ptr_->DrawSprite(x_pos, y_pos, background.get());
-        x_pos += background->width;
-      }
-      y_pos += background->height;
-    }
+    placement.y = (static_cast<int>((cam_position_px_y_ / scroll_slowdown_factor) -
+                                    kScreenHeightPx) %
+                   image.height);
+    placement.num_y = num_copies(placement.y, image.height, kScreenHeightPx);
   }
-  // LOG_INFO("number of draws " << num_of_background_draws);
+  return placement;
 }
 
-void RenderingSystem::RenderTiles() {
+void RenderingSystem::SubmitTiles() {
   KeepCameraInBounds();
-
-  const auto position = GetCameraPosition();
-  const auto& tilemap = level_.tile_grid;
-  const auto& tileset = *level_.level_tileset;
-  for (int y_itr = 0; y_itr <= viewport_height_ + 1; ++y_itr) {
-    for (int x_itr = 0; x_itr <= viewport_width_ + 1; ++x_itr) {
-      const double lookup_x = position.x + x_itr;
-      const double lookup_y = position.y + y_itr;
-      const int lookup_x_int = static_cast<int>(std::floor(lookup_x));
-      const int lookup_y_int = static_cast<int>(std::floor(lookup_y));
-      int tile_idx{};
-      if (lookup_x_int >= 0 && lookup_x_int < tilemap.GetWidth() && lookup_y_int >= 0 &&
-          lookup_y_int < tilemap.GetHeight()) {
-        tile_idx = tilemap.GetTile(lookup_x_int, lookup_y_int).tile_id;
-      }
-      auto* tile = tileset.GetTile(tile_idx);
-      if (tile_idx == 0) {
-        continue;
-      }
-
-      const double x_fraction = lookup_x - lookup_x_int;
-      const double y_fraction = lookup_y - lookup_y_int;
-
-      const int x_px = static_cast<int>(std::round((x_itr - x_fraction) * tile_size_));
-      const int y_px =
-          static_cast<int>(std::round(kScreenHeightPx - (y_itr + 1 - y_fraction) * tile_size_));
-      //   std::cout << " itrs " << x_itr << " " << y_itr << " "                        //
-      //             << " global " << lookup_x << " " << lookup_y << " "                //
-      //             << " global floor " << lookup_x_int << " " << lookup_y_int << " "  //
-      //             << " faction " << x_fraction << " " << y_fraction << " "           //
-      //             << " pixel " << x_px << " " << y_px << " "                         //
-      //             << " tile " << tile_idx << std::endl;                              //
-
-      engine_ptr_->DrawSprite(x_px, y_px, tile);
-    }
-  }
+  tile_chunks_.Submit(cam_position_px_x_, cam_position_px_y_, kScreenWidthPx, kScreenHeightPx,
+                      RenderLayer::kTiles, render_queue_);
 }
 
 // TODO(BT-21): Copy-pasta from RenderTiles
-void RenderingSystem::RenderOccupancyGrid(const Grid<EntityId>& grid) {
+void RenderingSystem::RenderOccupancyGrid(const SpatialHash& grid) {
+  last_frame_tracked_ = false;
+  const ScopedEngineDrawTarget engine_target{engine_ptr_, &GetRenderTarget()};
   const auto position = GetCameraPosition();
   olc::Sprite red{tile_size_, tile_size_};
   for (int y = 0; y < red.height; ++y) {
@@ -273,12 +428,8 @@ void RenderingSystem::RenderOccupancyGrid(const Grid<EntityId>& grid) {
       const double lookup_y = position.y + y_itr;
       const int lookup_x_int = static_cast<int>(std::floor(lookup_x));
       const int lookup_y_int = static_cast<int>(std::floor(lookup_y));
-      EntityId entity_id{};
-      if (lookup_x_int >= 0 && lookup_x_int < grid.GetWidth() && lookup_y_int >= 0 &&
-          lookup_y_int < grid.GetHeight()) {
-        entity_id = grid.GetTile(lookup_x_int, lookup_y_int);
-      }
-      if (entity_id == 0) {
+      if (lookup_x_int < 0 || lookup_x_int >= grid.GetWidth() || lookup_y_int < 0 ||
+          lookup_y_int >= grid.GetHeight() || grid.GetCell(lookup_x_int, lookup_y_int).empty()) {
         continue;
       }
 
@@ -294,76 +445,171 @@ void RenderingSystem::RenderOccupancyGrid(const Grid<EntityId>& grid) {
   }
 }
 
-void RenderingSystem::RenderEntities() {
-  for (auto id : CombineViews(registry_->GetView<Position, AnimatedSpriteComponent>(),
-                              registry_->GetView<Position, SpriteComponent>())) {
-    this->DrawSprite(id);
+void RenderingSystem::RenderEntities() { RenderEntities(CaptureSnapshot()); }
+
+RenderSnapshot RenderingSystem::CaptureSnapshot() const {
+  const bool draw_collisions =
+      parameter_server_->GetParameter<double>("viz/draw.player.collisions") == 1.;
+  const auto with_sprite = CombineViews(registry_->GetView<Position, AnimatedSpriteComponent>(),
+                                        registry_->GetView<Position, SpriteComponent>());
+  const auto with_primitive = registry_->GetView<Position, PrimitiveComponent>();
+
+  auto ids = CombineViews(with_sprite, with_primitive);
+  if (draw_collisions) {
+    const auto with_collisions = registry_->GetView<Position, Collision, CollisionBox>();
+    ids = CombineViews(ids, with_collisions);
   }
 
-  if (parameter_server_->GetParameter<double>("viz/draw.player.collisions") == 1.) {
-    for (auto id : registry_->GetView<Position, Collision, CollisionBox>()) {
-      RenderEntityCollisionBox(id);
+  const auto sprite_extent = animation_manager_->GetMaxSpriteExtent();
+  const SpriteExtent max_extent{
+      sprite_extent.left + kCullMarginPx, sprite_extent.right + kCullMarginPx,
+      sprite_extent.up + kCullMarginPx, sprite_extent.down + kCullMarginPx};
+
+  RenderSnapshot snapshot;
+  snapshot.entities.reserve(ids.size());
+  for (const auto id : ids) {
+    const auto& position = registry_->GetComponent<Position>(id);
+    if (!IsInView(position, max_extent)) {
+      continue;
+    }
+    RenderEntity entity{};
+    entity.id = id;
+    entity.position = position;
+    if (registry_->HasComponent<FacingDirection>(id)) {
+      entity.facing = registry_->GetComponent<FacingDirection>(id).facing;
+    }
+    if (std::binary_search(with_sprite.begin(), with_sprite.end(), id)) {
+      const auto sprite = animation_manager_->GetSprite(id);
+      const auto extent = GetSpriteExtent(sprite.sprite_ptr->width, sprite.sprite_ptr->height,
+                                          sprite.draw_offset_x, sprite.draw_offset_y);
+      if (IsInView(position, extent)) {
+        entity.sprite = sprite;
+      }
+    }
+    if (registry_->HasComponent<PrimitiveComponent>(id)) {
+      entity.primitive = registry_->GetComponent<PrimitiveComponent>(id);
+    }
+    if (draw_collisions && registry_->HasComponents<Collision, CollisionBox>(id)) {
+      entity.collision_box = registry_->GetComponent<CollisionBox>(id);
+      entity.collisions = registry_->GetComponent<Collision>(id);
+    }
+    if (entity.sprite.has_value() || entity.primitive.has_value() ||
+        entity.collision_box.has_value()) {
+      snapshot.entities.push_back(std::move(entity));
     }
   }
+  return snapshot;
+}
+
+bool RenderingSystem::IsInView(const Position& world_pos, const SpriteExtent& extent) const {
+  const auto [px_x, px_y] = GetPixelLocation(world_pos);
+  return px_x + extent.right > 0 && px_x - extent.left < kScreenWidthPx &&
+         px_y + extent.down > 0 && px_y - extent.up < kScreenHeightPx;
+}
+
+void RenderingSystem::RenderEntities(const RenderSnapshot& snapshot) {
+  SubmitEntities(snapshot);
+  Rasterize();
+}
 
-  for (auto id : registry_->GetView<Position, DrawFunction>()) {
-    auto [position, fn] = registry_->GetComponents<Position, DrawFunction>(id);
-    const auto [px_x, px_y] = GetPixelLocation(position);
-    fn.draw_fn(px_x, px_y, engine_ptr_);
+void RenderingSystem::SubmitEntities(const RenderSnapshot& snapshot) {
+  entity_primitives_.clear();
+  for (const auto& entity : snapshot.entities) {
+    if (entity.sprite.has_value()) {
+      SubmitSprite(entity);
+    }
+    if (entity.collision_box.has_value()) {
+      SubmitEntityCollisionBox(entity);
+    }
+    if (entity.primitive.has_value()) {
+      const auto [px_x, px_y] = GetPixelLocation(entity.position);
+      entity_primitives_.push_back(
+          Primitive{px_x, px_y, ToPixel(entity.primitive->color), entity.primitive->shape});
+    }
   }
+  render_queue_.SubmitPrimitives(RenderLayer::kEffects, kEntityPrimitivesSortKey,
+                                 entity_primitives_.data(),
+                                 static_cast<int>(entity_primitives_.size()));
+
+  SubmitParticles(snapshot.particles);
 }
 
-Vector2i RenderingSystem::GetPixelLocation(const Position& world_pos) {
+void RenderingSystem::SubmitParticles(const ParticleSnapshot& particles) {
+  const auto camera = GetCameraPosition();
+  const auto num_particles = particles.x.size();
+  particle_primitives_.clear();
+  particle_primitives_.reserve(num_particles);
+  for (size_t i = 0; i < num_particles; ++i) {
+    // As GetPixelLocation.
+    const int px_x = static_cast<int>((particles.x[i] - camera.x) * tile_size_);
+    const int px_y = kScreenHeightPx - static_cast<int>((particles.y[i] - camera.y) * tile_size_);
+    if (px_x >= 0 && px_x < kScreenWidthPx && px_y >= 0 && px_y < kScreenHeightPx) {
+      particle_primitives_.push_back(
+          Primitive{px_x, px_y, particles.color[i], PrimitiveShape::kPoint});
+    }
+  }
+  render_queue_.SubmitPrimitives(RenderLayer::kEffects, kParticlesSortKey,
+                                 particle_primitives_.data(),
+                                 static_cast<int>(particle_primitives_.size()));
+}
+
+Vector2i RenderingSystem::GetPixelLocation(const Position& world_pos) const {
   const auto position_in_screen = Vector2d{world_pos.x, world_pos.y} - GetCameraPosition();
   const int top_left_px_x = static_cast<int>(position_in_screen.x * tile_size_);
   const int top_left_px_y = kScreenHeightPx - static_cast<int>(position_in_screen.y * tile_size_);
   return {top_left_px_x, top_left_px_y};
 }
 
-Vector2i RenderingSystem::GetPixelLocation(const Position& world_pos, const Sprite& sprite) {
+Vector2i RenderingSystem::GetPixelLocation(const Position& world_pos,
+                                           const Sprite& sprite) const {
   auto [top_left_px_x, top_left_px_y] = GetPixelLocation(world_pos);
   top_left_px_x -= sprite.draw_offset_x;
   top_left_px_y -= (sprite.sprite_ptr->height - sprite.draw_offset_y);
   return {top_left_px_x, top_left_px_y};
 }
 
-void RenderingSystem::DrawSprite(const EntityId id) {
-  RB_CHECK(registry_->HasComponent<Position>(id));
-  const auto& position = registry_->GetComponent<Position>(id);
-  const auto sprite = animation_manager_->GetSprite(id);
+void RenderingSystem::SubmitSprite(const RenderEntity& entity) {
+  RB_CHECK(entity.sprite.has_value());
+  const auto& sprite = *entity.sprite;
   // TODO(BT-14): Sprite offset not applied properly for flipped sprites
-  const auto [top_left_px_x, top_left_px_y] = GetPixelLocation(position, sprite);
-  const auto flip = GetFlip(id, *registry_);
-  engine_ptr_->DrawSprite(top_left_px_x, top_left_px_y, const_cast<olc::Sprite*>(sprite.sprite_ptr),
-                          1, flip);
+  const auto top_left_px = GetPixelLocation(entity.position, sprite);
+  const auto flip = GetFlip(entity.facing);
+  auto* sprite_ptr = const_cast<olc::Sprite*>(sprite.sprite_ptr);
+  if (sprite.spans != nullptr) {
+    render_queue_.SubmitSprite(RenderLayer::kEntities, GetSortKey(entity), sprite_ptr->GetData(),
+                               *sprite.spans, top_left_px.x, top_left_px.y, flip);
+    return;
+  }
+  render_queue_.SubmitCallback(
+      RenderLayer::kEntities, GetSortKey(entity), [this, top_left_px, sprite_ptr, flip] {
+        const ScopedEngineDrawTarget engine_target{engine_ptr_, &GetRenderTarget()};
+        engine_ptr_->DrawSprite(top_left_px.x, top_left_px.y, sprite_ptr, 1, flip);
+      });
 }
 
-void RenderingSystem::RenderEntityCollisionBox(EntityId id) {
-  if (!registry_->HasComponents<Position, Collision, CollisionBox>(id)) {
+void RenderingSystem::SubmitEntityCollisionBox(const RenderEntity& entity) {
+  if (!entity.collision_box.has_value() || !entity.collisions.has_value()) {
     return;
   }
-  auto [position, collision_box, collisions] =
-      registry_->GetComponents<Position, CollisionBox, Collision>(id);
-  const auto pixel_pos = this->GetPixelLocation(position);
+  const auto& collision_box = *entity.collision_box;
+  const auto& collisions = *entity.collisions;
+  const auto pixel_pos = this->GetPixelLocation(entity.position);
   const auto& bb_width = collision_box.collision_width_px;
   const auto& bb_height = collision_box.collision_height_px;
   const auto bb_bottom_left_x = pixel_pos.x + collision_box.x_offset_px;
   const auto bb_bottom_left_y = pixel_pos.y + collision_box.y_offset_px;
-  auto color = collisions.bottom ? olc::WHITE : olc::BLACK;
-  engine_ptr_->DrawLine(bb_bottom_left_x, bb_bottom_left_y, bb_bottom_left_x + bb_width,
-                        bb_bottom_left_y, color);
-
-  color = collisions.top ? olc::WHITE : olc::BLACK;
-  engine_ptr_->DrawLine(bb_bottom_left_x, bb_bottom_left_y - bb_height, bb_bottom_left_x + bb_width,
-                        bb_bottom_left_y - bb_height, color);
-
-  color = collisions.left ? olc::WHITE : olc::BLACK;
-  engine_ptr_->DrawLine(bb_bottom_left_x, bb_bottom_left_y, bb_bottom_left_x,
-                        bb_bottom_left_y - bb_height, color);
-
-  color = collisions.right ? olc::WHITE : olc::BLACK;
-  engine_ptr_->DrawLine(bb_bottom_left_x + bb_width, bb_bottom_left_y, bb_bottom_left_x + bb_width,
-                        bb_bottom_left_y - bb_height, color);
+  const auto submit_line = [&](int x0, int y0, int x1, int y1, bool colliding) {
+    render_queue_.SubmitLine(RenderLayer::kDebug, GetSortKey(entity), x0, y0, x1, y1,
+                             colliding ? olc::WHITE : olc::BLACK);
+  };
+  submit_line(bb_bottom_left_x, bb_bottom_left_y, bb_bottom_left_x + bb_width, bb_bottom_left_y,
+              collisions.bottom);
+  submit_line(bb_bottom_left_x, bb_bottom_left_y - bb_height, bb_bottom_left_x + bb_width,
+              bb_bottom_left_y - bb_height, collisions.top);
+  submit_line(bb_bottom_left_x, bb_bottom_left_y, bb_bottom_left_x, bb_bottom_left_y - bb_height,
+              collisions.left);
+  submit_line(bb_bottom_left_x + bb_width, bb_bottom_left_y, bb_bottom_left_x + bb_width,
+              bb_bottom_left_y - bb_height, collisions.right);
 }
 
 void RenderingSystem::KeepCameraInBounds() {
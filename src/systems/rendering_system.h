@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "common_types/entity.h"
 #include "common_types/grid.h"
@@ -10,8 +11,16 @@
 #include "animation/sprite_manager.h"
 #include "common_types/basic_types.h"
 #include "common_types/game_configuration.h"
+#include "common_types/spatial_hash.h"
 #include "registry.h"
 #include "registry_helpers.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/primitive_batch.h"
+#include "rendering/render_queue.h"
+#include "rendering/render_snapshot.h"
+#include "rendering/sprite_spans.h"
+#include "rendering/tile_chunk_cache.h"
+#include "utils/job_system.h"
 #include "utils/parameter_server.h"
 #include "utils/simple_profiler.h"
 
@@ -27,7 +36,8 @@ class RenderingSystem {
                   Level level,
                   std::shared_ptr<ParameterServer> parameter_server,
                   std::shared_ptr<SpriteManager> animation_manager,
-                  std::shared_ptr<Registry> registry);
+                  std::shared_ptr<Registry> registry,
+                  std::shared_ptr<JobSystem> job_system);
 
   [[nodiscard]] Vector2d GetCameraPosition() const;
   void SetCameraPosition(const Vector2d& absolute_vec);
@@ -38,11 +48,30 @@ class RenderingSystem {
   // as a fraction of the screen size.
   void KeepPlayerInFrame(const EntityId player_id);
 
+  // Draw into the target, e.g. an in-memory framebuffer, instead of the engine's draw target.
+  // The engine then does not need a window. nullptr goes back to the engine's draw target.
+  void SetRenderTarget(olc::Sprite* target);
+
+  // Background, tiles, entities and foreground.
+  // With threading/banded.rendering, the frame is rasterized in horizontal bands on the job
+  // system. With rendering/damage.tracking, only the rows that changed since the previous frame are
+  // redrawn while the camera stands still. The result is the same either way.
+  void RenderFrame(const RenderSnapshot& snapshot);
+
   void RenderBackground();
   void RenderForeground();
   void RenderTiles();
   void RenderEntities();
 
+  // Copy everything needed to render the entities out of the registry.
+  // Entities that cannot be on screen are culled before their sprites are looked up.
+  // Must not run concurrently with systems that write to the registry.
+  [[nodiscard]] RenderSnapshot CaptureSnapshot() const;
+
+  // As RenderEntities, but only uses the snapshot, i.e. does not touch the registry.
+  // This may run concurrently with the simulation.
+  void RenderEntities(const RenderSnapshot& snapshot);
+
   // Add a background layer to render.
   // Backgrounds will be rendered in the order that they are added.
   // A scroll slowdown factor of 2 moves the image at half the speed of the camera.
@@ -60,31 +89,68 @@ class RenderingSystem {
   //                    2) All your background layers have transparency.
   void AddFoundationBackgroundLayer(uint8_t r, uint8_t g, uint8_t b);
 
-  void RenderOccupancyGrid(const Grid<EntityId>& grid);
+  void RenderOccupancyGrid(const SpatialHash& grid);
 
  private:
   struct BackgroundLayer {
     std::unique_ptr<olc::Sprite> background_img;
+    SpriteSpans spans;
     double scroll_slowdown_factor;
   };
 
-  Vector2i GetPixelLocation(const Position& world_pos);
-  Vector2i GetPixelLocation(const Position& world_pos, const Sprite& sprite);
-  void DrawSprite(EntityId id);
+  // Where a background image is drawn for the current camera position: num_x by num_y copies side
+  // by side, the first one with its top left corner at (x, y).
+  struct LayerPlacement {
+    int x;
+    int y;
+    int num_x;
+    int num_y;
+  };
+
+  Vector2i GetPixelLocation(const Position& world_pos) const;
+  Vector2i GetPixelLocation(const Position& world_pos, const Sprite& sprite) const;
+  // Whether anything of the given extent drawn at the position's pixel can be on screen.
+  [[nodiscard]] bool IsInView(const Position& world_pos, const SpriteExtent& extent) const;
   void KeepCameraInBounds();
-  void RenderBackgroundLayer(const BackgroundLayer& background_layer);
-  void RenderEntityCollisionBox(EntityId entity_id);
+  [[nodiscard]] olc::Sprite& GetRenderTarget() const;
+  [[nodiscard]] LayerPlacement GetLayerPlacement(const olc::Sprite& image,
+                                                 double scroll_slowdown_factor) const;
+  void UpdateBackgroundComposite();
+
+  // The Render functions submit their draws to render_queue_, then call Rasterize.
+  // Submissions may refer to the snapshot, so it must outlive the call to Rasterize.
+  void SubmitBackground();
+  void SubmitForeground();
+  void SubmitBackgroundLayer(const BackgroundLayer& background_layer, RenderLayer layer);
+  void SubmitTiles();
+  void SubmitEntities(const RenderSnapshot& snapshot);
+  void SubmitSprite(const RenderEntity& entity);
+  void SubmitEntityCollisionBox(const RenderEntity& entity);
+  void SubmitParticles(const ParticleSnapshot& particles);
+  // Flushes the render queue into draw commands and rasterizes them onto the draw target.
+  void Rasterize();
+  // As Rasterize, but only redraws the damaged rows if the previous frame was drawn the same way.
+  void RasterizeDamage();
+  void ReplayCommands(olc::Sprite& target);
 
   olc::PixelGameEngine* engine_ptr_;
+  olc::Sprite* render_target_{nullptr};  // The engine's draw target if null.
 
   std::shared_ptr<ParameterServer> parameter_server_;
   std::shared_ptr<SpriteManager> animation_manager_;
   std::shared_ptr<Registry> registry_; // TODO(BT-07):: Should be const
+  std::shared_ptr<JobSystem> job_system_;
 
   // std::unique_ptr<olc::Sprite> background_;
   std::vector<BackgroundLayer> background_layers_;
   std::vector<BackgroundLayer> foreground_layers_;
   std::optional<olc::Pixel> foundation_background_color_;
+  // The foundation color and the bottom num_composited_layers_ background layers, blended into one
+  // opaque image that is copied to the screen instead of blending the layers every frame.
+  // These layers have the same size and scroll factor, so they always move together and the
+  // composite only changes when layers are added. Null if there is no opaque base to blend onto.
+  std::unique_ptr<olc::Sprite> background_composite_;
+  int num_composited_layers_{};
 
   // Camera position is the bottom right corner of the screen.
   // Stored in pixel coordinates, but with y up positive.
@@ -102,6 +168,21 @@ class RenderingSystem {
   double viewport_width_;   // The width in tile units.
   double viewport_height_;  // The height in tile units.
 
+  TileChunkCache tile_chunks_;
+  RenderQueue render_queue_;
+  DrawCommandList commands_;
+  // The primitives of the entities and particles of the frame, each submitted as one batch.
+  std::vector<Primitive> entity_primitives_;
+  std::vector<Primitive> particle_primitives_;
+
+  // Damage tracking: whether the target still holds the last frame drawn by RasterizeDamage, and
+  // where it was drawn from.
+  bool last_frame_tracked_{false};
+  const olc::Sprite* last_frame_target_{nullptr};
+  int last_frame_cam_px_x_{};
+  int last_frame_cam_px_y_{};
+  std::vector<RowRange> damaged_rows_;
+
   SimpleProfiler profiler_;
 };
 
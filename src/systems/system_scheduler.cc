@@ -0,0 +1,88 @@
+#include "systems/system_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+bool Intersects(const std::set<std::string>& lhs, const std::set<std::string>& rhs) {
+  return std::any_of(lhs.begin(), lhs.end(),
+                     [&rhs](const std::string& resource) { return rhs.count(resource) != 0; });
+}
+
+}  // namespace
+
+bool SystemAccess::ConflictsWith(const SystemAccess& other) const {
+  if ((writes & (other.reads | other.writes)).any() || (other.writes & reads).any()) {
+    return true;
+  }
+  return Intersects(write_resources, other.read_resources) ||
+         Intersects(write_resources, other.write_resources) ||
+         Intersects(other.write_resources, read_resources);
+}
+
+SystemScheduler::SystemScheduler(std::shared_ptr<JobSystem> job_system)
+    : job_system_{std::move(job_system)} {
+  RB_CHECK(job_system_ != nullptr);
+}
+
+void SystemScheduler::AddSystem(std::string name,
+                                SystemAccess access,
+                                std::function<void()> system) {
+  const int new_idx = static_cast<int>(systems_.size());
+  SystemNode node{std::move(name), std::move(access), std::move(system), {}, {}};
+  for (int i = 0; i < new_idx; ++i) {
+    if (systems_[i].access.ConflictsWith(node.access)) {
+      node.dependencies.push_back(i);
+      systems_[i].dependents.push_back(new_idx);
+    }
+  }
+  systems_.push_back(std::move(node));
+}
+
+std::vector<int> SystemScheduler::GetDependencies(const int system_idx) const {
+  return systems_.at(system_idx).dependencies;
+}
+
+void SystemScheduler::RunSerial() {
+  for (auto& node : systems_) {
+    node.system();
+  }
+}
+
+void SystemScheduler::Run() {
+  if (job_system_->GetNumWorkers() == 0) {
+    RunSerial();
+    return;
+  }
+  std::vector<std::atomic<int>> remaining(systems_.size());
+  for (size_t i = 0; i < systems_.size(); ++i) {
+    remaining[i].store(static_cast<int>(systems_[i].dependencies.size()));
+  }
+  TaskGroup group{*job_system_};
+  for (int i = 0; i < GetNumSystems(); ++i) {
+    if (systems_[i].dependencies.empty()) {
+      group.Run([this, i, &group, &remaining] { RunSystem(i, group, remaining); });
+    }
+  }
+  group.Wait();
+}
+
+void SystemScheduler::RunSystem(const int system_idx,
+                                TaskGroup& group,
+                                std::vector<std::atomic<int>>& remaining) {
+  systems_[system_idx].system();
+  // The last dependency to finish releases a system. Dependents stay blocked if this one threw.
+  for (const int dependent : systems_[system_idx].dependents) {
+    if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      group.Run([this, dependent, &group, &remaining] { RunSystem(dependent, group, remaining); });
+    }
+  }
+}
+
+}  // namespace platformer
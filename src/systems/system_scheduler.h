@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "registry.h"
+#include "utils/job_system.h"
+
+namespace platformer {
+
+using ComponentMask = std::bitset<Registry::GetNumComponentTypes()>;
+
+// What a system touches. Two systems conflict if one writes something the other reads or writes.
+// Usage:
+// SystemAccess{}.Reads<StateComponent>().Writes<Velocity>().ReadsResource("animation_events")
+struct SystemAccess {
+  template <typename... Components>
+  SystemAccess& Reads() {
+    (reads.set(Registry::GetComponentIndex<Components>()), ...);
+    return *this;
+  }
+
+  template <typename... Components>
+  SystemAccess& Writes() {
+    (writes.set(Registry::GetComponentIndex<Components>()), ...);
+    return *this;
+  }
+
+  // Adding or removing entities/components invalidates every view, so it counts as writing all
+  // component types.
+  SystemAccess& Structural() {
+    writes.set();
+    return *this;
+  }
+
+  // Resources are anything shared outside of the registry, e.g. the event lists passed between
+  // systems, the audio device or a random number generator.
+  SystemAccess& ReadsResource(const std::string& resource) {
+    read_resources.insert(resource);
+    return *this;
+  }
+
+  SystemAccess& WritesResource(const std::string& resource) {
+    write_resources.insert(resource);
+    return *this;
+  }
+
+  [[nodiscard]] bool ConflictsWith(const SystemAccess& other) const;
+
+  ComponentMask reads;
+  ComponentMask writes;
+  std::set<std::string> read_resources;
+  std::set<std::string> write_resources;
+};
+
+// Runs a list of systems, concurrently where their declared accesses allow it.
+//
+// Systems are added in their serial order. A system only waits for the earlier systems it
+// conflicts with, so the result is the same as running them one after the other, provided the
+// declared accesses are complete.
+class SystemScheduler {
+ public:
+  explicit SystemScheduler(std::shared_ptr<JobSystem> job_system);
+
+  void AddSystem(std::string name, SystemAccess access, std::function<void()> system);
+
+  // Runs every system once. Rethrows the first exception thrown by a system, systems depending
+  // on a failed one are not run.
+  void Run();
+
+  // Runs every system once on the calling thread, in the order they were added.
+  void RunSerial();
+
+  // Indices of the earlier systems system_idx waits for.
+  [[nodiscard]] std::vector<int> GetDependencies(int system_idx) const;
+
+  [[nodiscard]] const std::string& GetName(int system_idx) const {
+    return systems_.at(system_idx).name;
+  }
+  [[nodiscard]] int GetNumSystems() const { return static_cast<int>(systems_.size()); }
+
+ private:
+  struct SystemNode {
+    std::string name;
+    SystemAccess access;
+    std::function<void()> system;
+    std::vector<int> dependencies;
+    std::vector<int> dependents;
+  };
+
+  void RunSystem(int system_idx, TaskGroup& group, std::vector<std::atomic<int>>& remaining);
+
+  std::shared_ptr<JobSystem> job_system_;
+  std::vector<SystemNode> systems_;
+};
+
+}  // namespace platformer
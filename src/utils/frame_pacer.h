@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "chrono_helpers.h"
+
+namespace platformer {
+
+struct JitterStatistics {
+  int64_t num_samples{};
+  double target_period_us{};
+  double mean_period_us{};
+  double stddev_period_us{};
+  double min_period_us{};
+  double max_period_us{};
+  double max_abs_error_us{};  // Worst deviation of a single period from the target period.
+  double sleep_margin_us{};   // Current calibrated spin margin of the pacer.
+};
+
+inline std::string ToString(const JitterStatistics& stats) {
+  std::ostringstream oss;
+  oss << "frame period (us): target " << stats.target_period_us << ", mean " << stats.mean_period_us
+      << ", stddev " << stats.stddev_period_us << ", min " << stats.min_period_us << ", max "
+      << stats.max_period_us << ", max error " << stats.max_abs_error_us << " (" << stats.num_samples
+      << " samples, spin margin " << stats.sleep_margin_us << "us)";
+  return oss.str();
+}
+
+// Keeps the last N achieved frame periods and summarizes them.
+class PeriodStatistics {
+ public:
+  explicit PeriodStatistics(Duration target_period) : target_period_{target_period} {}
+
+  void AddSample(Duration period) {
+    periods_us_.push_back(ToUs(period));
+    while (periods_us_.size() > kBufferSize) {
+      periods_us_.pop_front();
+    }
+  }
+
+  void Clear() { periods_us_.clear(); }
+
+  [[nodiscard]] JitterStatistics Get() const {
+    JitterStatistics stats{};
+    const auto target_us = static_cast<double>(ToUs(target_period_));
+    stats.target_period_us = target_us;
+    stats.num_samples = static_cast<int64_t>(periods_us_.size());
+    if (periods_us_.empty()) {
+      return stats;
+    }
+    double sum{};
+    stats.min_period_us = static_cast<double>(periods_us_.front());
+    stats.max_period_us = stats.min_period_us;
+    for (const auto period : periods_us_) {
+      const auto period_f = static_cast<double>(period);
+      sum += period_f;
+      stats.min_period_us = std::min(stats.min_period_us, period_f);
+      stats.max_period_us = std::max(stats.max_period_us, period_f);
+      stats.max_abs_error_us = std::max(stats.max_abs_error_us, std::abs(period_f - target_us));
+    }
+    stats.mean_period_us = sum / static_cast<double>(periods_us_.size());
+    double sum_sq{};
+    for (const auto period : periods_us_) {
+      const double diff = static_cast<double>(period) - stats.mean_period_us;
+      sum_sq += diff * diff;
+    }
+    stats.stddev_period_us = std::sqrt(sum_sq / static_cast<double>(periods_us_.size()));
+    return stats;
+  }
+
+ private:
+  static constexpr int kBufferSize = 100;
+  Duration target_period_;
+  std::deque<int64_t> periods_us_;
+};
+
+// Waits until a deadline more precisely than std::this_thread::sleep_for.
+//
+// sleep_for regularly oversleeps by 50-200us (linux) or up to a scheduler quantum (windows).
+// The pacer sleeps coarsely until `margin` before the deadline, then yields in a loop for the
+// final stretch. The margin tracks the measured oversleep of the coarse sleeps (mean + a few
+// deviations), so on a quiet machine only a fraction of a millisecond per frame is spent yielding.
+class FramePacer {
+ public:
+  FramePacer() = default;
+
+  // The deadline is in steady clock time, i.e. not the (pausable) game clock.
+  void WaitUntil(const TimePoint deadline) {
+    const auto margin = GetSleepMargin();
+    const auto coarse_wake = deadline - margin;
+    auto now = Clock::now();
+    if (coarse_wake > now) {
+      std::this_thread::sleep_until(coarse_wake);
+      const auto woke_at = Clock::now();
+      UpdateCalibration(woke_at - coarse_wake);
+      now = woke_at;
+    }
+    while (now < deadline) {
+      std::this_thread::yield();
+      now = Clock::now();
+    }
+  }
+
+  [[nodiscard]] Duration GetSleepMargin() const {
+    const double margin_us = std::clamp(mean_oversleep_us_ + kDeviations * mean_deviation_us_,
+                                        kMinMarginUs, kMaxMarginUs);
+    return FromSecs(margin_us * 1e-6);
+  }
+
+ private:
+  void UpdateCalibration(const Duration oversleep) {
+    // Exponentially weighted mean and mean absolute deviation of the oversleep.
+    const auto oversleep_us = static_cast<double>(ToUs(oversleep));
+    const double deviation = std::abs(oversleep_us - mean_oversleep_us_);
+    mean_oversleep_us_ += kSmoothing * (oversleep_us - mean_oversleep_us_);
+    mean_deviation_us_ += kSmoothing * (deviation - mean_deviation_us_);
+  }
+
+  static constexpr double kSmoothing = 0.05;
+  static constexpr double kDeviations = 3.0;
+  static constexpr double kMinMarginUs = 50.0;
+  static constexpr double kMaxMarginUs = 4000.0;
+
+  // Start pessimistic, the calibration converges within a few dozen frames.
+  double mean_oversleep_us_{500.0};
+  double mean_deviation_us_{200.0};
+};
+
+}  // namespace platformer
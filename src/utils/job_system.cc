@@ -0,0 +1,175 @@
+#include "utils/job_system.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+namespace {
+
+// Which job system (if any) the current thread is a worker of, and its queue index.
+thread_local const JobSystem* tls_job_system = nullptr;
+thread_local int tls_thread_index = 0;
+
+}  // namespace
+
+TaskGroup::~TaskGroup() {
+  // Never leave jobs behind that reference this group. Exceptions are dropped here, call Wait() to
+  // observe them.
+  while (pending_.load(std::memory_order_acquire) > 0) {
+    if (!job_system_.TryRunOne()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+  if (job_system_.GetNumWorkers() == 0) {
+    JobSystem::Job job{std::move(task), this};
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    JobSystem::Execute(job);
+    return;
+  }
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  job_system_.Push(JobSystem::Job{std::move(task), this});
+}
+
+void TaskGroup::Wait() {
+  while (pending_.load(std::memory_order_acquire) > 0) {
+    if (!job_system_.TryRunOne()) {
+      std::this_thread::yield();
+    }
+  }
+  std::lock_guard<std::mutex> lock{exception_mutex_};
+  if (exception_) {
+    std::rethrow_exception(std::exchange(exception_, nullptr));
+  }
+}
+
+void TaskGroup::Finished(std::exception_ptr exception) {
+  if (exception) {
+    std::lock_guard<std::mutex> lock{exception_mutex_};
+    if (!exception_) {
+      exception_ = std::move(exception);
+    }
+  }
+  pending_.fetch_sub(1, std::memory_order_release);
+}
+
+JobSystem::JobSystem(const int num_workers) {
+  RB_CHECK(num_workers >= 0);
+  for (int i = 0; i < num_workers + 1; ++i) {
+    queues_.emplace_back(std::make_unique<WorkQueue>());
+  }
+  for (int i = 1; i <= num_workers; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    stop_ = true;
+  }
+  wake_condition_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+int JobSystem::DefaultNumWorkers() {
+  const int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(0, hardware_threads - 1);
+}
+
+int JobSystem::CurrentThreadIndex() const {
+  return tls_job_system == this ? tls_thread_index : 0;
+}
+
+void JobSystem::Push(Job job) {
+  auto& queue = *queues_[CurrentThreadIndex()];
+  {
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.jobs.push_back(std::move(job));
+  }
+  num_queued_.fetch_add(1, std::memory_order_release);
+  {
+    // Taking the lock orders this notify after a sleeping worker has checked its predicate.
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+  }
+  wake_condition_.notify_one();
+}
+
+bool JobSystem::PopOwn(const int thread_index, Job& job) {
+  auto& queue = *queues_[thread_index];
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.jobs.empty()) {
+    return false;
+  }
+  job = std::move(queue.jobs.back());
+  queue.jobs.pop_back();
+  return true;
+}
+
+bool JobSystem::Steal(const int thread_index, Job& job) {
+  const int num_queues = static_cast<int>(queues_.size());
+  for (int offset = 1; offset < num_queues; ++offset) {
+    auto& queue = *queues_[(thread_index + offset) % num_queues];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.jobs.empty()) {
+      continue;
+    }
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    return true;
+  }
+  return false;
+}
+
+bool JobSystem::TryRunOne() {
+  if (num_queued_.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+  const int thread_index = CurrentThreadIndex();
+  Job job;
+  if (!PopOwn(thread_index, job) && !Steal(thread_index, job)) {
+    return false;
+  }
+  num_queued_.fetch_sub(1, std::memory_order_relaxed);
+  Execute(job);
+  return true;
+}
+
+void JobSystem::Execute(Job& job) {
+  std::exception_ptr exception;
+  try {
+    job.task();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  // Release the task (and anything it captured) before signalling the group.
+  job.task = nullptr;
+  job.group->Finished(std::move(exception));
+}
+
+void JobSystem::WorkerLoop(const int thread_index) {
+  tls_job_system = this;
+  tls_thread_index = thread_index;
+  while (true) {
+    if (TryRunOne()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    wake_condition_.wait(lock, [this] {
+      return stop_ || num_queued_.load(std::memory_order_acquire) > 0;
+    });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+}  // namespace platformer
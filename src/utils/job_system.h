@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace platformer {
+
+class JobSystem;
+
+// Fork/join handle: jobs started with Run() are joined by Wait().
+// A thread that waits does not block, it executes pending jobs (its own or stolen) until the
+// group has finished, so groups may be nested freely (e.g. a job that itself runs a ParallelFor).
+class TaskGroup {
+ public:
+  explicit TaskGroup(JobSystem& job_system) : job_system_{job_system} {}
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void Run(std::function<void()> task);
+
+  // Rethrows the first exception thrown by any of the jobs.
+  void Wait();
+
+ private:
+  friend class JobSystem;
+  void Finished(std::exception_ptr exception);
+
+  JobSystem& job_system_;
+  std::atomic<int> pending_{0};
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+// A work stealing thread pool.
+// Each worker owns a deque of jobs. It pushes and pops its own jobs at the back (LIFO, cache
+// friendly for fork/join), idle workers steal from the front of the other deques. Jobs submitted
+// by threads outside of the pool go to a shared queue that everyone steals from.
+//
+// With zero workers every job runs inline on the submitting thread.
+class JobSystem {
+ public:
+  explicit JobSystem(int num_workers);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // A sensible default: one worker per core, minus the main thread.
+  [[nodiscard]] static int DefaultNumWorkers();
+
+  [[nodiscard]] int GetNumWorkers() const { return static_cast<int>(workers_.size()); }
+
+  // Maximum number of threads executing jobs at once, i.e. the workers plus a waiting thread.
+  [[nodiscard]] int GetConcurrency() const { return GetNumWorkers() + 1; }
+
+  // Index of the calling thread in [0, GetConcurrency()).
+  // Zero for any thread that is not a worker of this job system.
+  // Use it to index per thread scratch buffers inside jobs.
+  [[nodiscard]] int CurrentThreadIndex() const;
+
+  // Calls fn(chunk_begin, chunk_end) for consecutive chunks covering [begin, end).
+  // Chunks are at least grain_size long. Returns once all chunks are done.
+  template <typename Fn>
+  void ParallelForRange(int begin, int end, Fn&& fn, int grain_size = 1);
+
+  // As above, but calls fn(i) for each index.
+  template <typename Fn>
+  void ParallelFor(int begin, int end, Fn&& fn, int grain_size = 1) {
+    ParallelForRange(
+        begin, end,
+        [&fn](int chunk_begin, int chunk_end) {
+          for (int i = chunk_begin; i < chunk_end; ++i) {
+            fn(i);
+          }
+        },
+        grain_size);
+  }
+
+ private:
+  friend class TaskGroup;
+
+  struct Job {
+    std::function<void()> task;
+    TaskGroup* group;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void Push(Job job);
+  bool TryRunOne();
+  bool PopOwn(int thread_index, Job& job);
+  bool Steal(int thread_index, Job& job);
+  static void Execute(Job& job);
+  void WorkerLoop(int thread_index);
+
+  // queues_[0] is shared by all non worker threads, queues_[i] belongs to worker i.
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::atomic<int> num_queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_condition_;
+  bool stop_{false};
+};
+
+template <typename Fn>
+void JobSystem::ParallelForRange(const int begin, const int end, Fn&& fn, const int grain_size) {
+  const int count = end - begin;
+  if (count <= 0) {
+    return;
+  }
+  // A few chunks per thread gives the stealing something to balance with.
+  constexpr int kChunksPerThread = 4;
+  const int max_chunks = GetConcurrency() * kChunksPerThread;
+  const int chunk_size = std::max({1, grain_size, (count + max_chunks - 1) / max_chunks});
+  if (GetNumWorkers() == 0 || chunk_size >= count) {
+    fn(begin, end);
+    return;
+  }
+
+  TaskGroup group{*this};
+  int chunk_begin = begin;
+  for (; chunk_begin + chunk_size < end; chunk_begin += chunk_size) {
+    group.Run([&fn, chunk_begin, chunk_size] { fn(chunk_begin, chunk_begin + chunk_size); });
+  }
+  // The calling thread takes the last chunk itself, then helps with the rest.
+  std::exception_ptr exception;
+  try {
+    fn(chunk_begin, end);
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  group.Wait();
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace platformer
@@ -2,25 +2,31 @@
 
 #include <chrono>
 #include <iostream>
+#include <optional>
 #include <thread>
 
 #include "chrono_helpers.h"
+#include "frame_pacer.h"
+#include "game_clock.h"
 
 namespace platformer {
 
 class RateTimer {
  public:
-  explicit RateTimer(double rate) {
-    std::chrono::duration<double> period(1. / rate);
-    single_frame_ = std::chrono::duration_cast<Duration>(period);
+  explicit RateTimer(double rate)
+      : frame_end_{GameClock::NowGlobal()},
+        single_frame_{FromSecs(1. / rate)},
+        period_statistics_{single_frame_} {}
+
+  void Reset() {
     frame_end_ = GameClock::NowGlobal();
+    last_wake_.reset();
   }
 
-  void Reset() { frame_end_ = GameClock::NowGlobal(); }
-
   void Sleep(const bool debug) {
     if (GameClock::IsPausedGlobal()) {
       std::this_thread::sleep_for(single_frame_);
+      last_wake_.reset();
       return;
     }
     const auto now = GameClock::NowGlobal();
@@ -39,16 +45,34 @@ class RateTimer {
       Reset();
     }
 
-    std::this_thread::sleep_for(frame_end_ - now);
+    // The frame end is in game clock time, the pacer works on the steady clock.
+    pacer_.WaitUntil(Clock::now() + (frame_end_ - now));
     frame_end_ += single_frame_;
+
+    const auto woke_at = Clock::now();
+    if (last_wake_.has_value()) {
+      period_statistics_.AddSample(woke_at - *last_wake_);
+    }
+    last_wake_ = woke_at;
   }
 
   [[nodiscard]] Duration GetFrameDuration() const { return last_frame_duration_; }
 
+  // Statistics over the periods actually achieved by the last frames.
+  [[nodiscard]] JitterStatistics GetJitterStatistics() const {
+    auto stats = period_statistics_.Get();
+    stats.sleep_margin_us = static_cast<double>(ToUs(pacer_.GetSleepMargin()));
+    return stats;
+  }
+
  private:
   TimePoint frame_end_;
   Duration single_frame_;
   Duration last_frame_duration_;
+
+  FramePacer pacer_;
+  PeriodStatistics period_statistics_;
+  std::optional<TimePoint> last_wake_;
 };
 
-}  // namespace platformer
\ No newline at end of file
+}  // namespace platformer
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "chrono_helpers.h"
+
+namespace platformer {
+
+// Callbacks scheduled for a point in time, kept in a min-heap keyed by when they are due.
+// RunDue() only touches the timers that are due, so nothing needs to be polled every frame.
+// Not thread safe.
+class TimerQueue {
+ public:
+  using TimerId = uint64_t;
+  using Callback = std::function<void()>;
+
+  TimerId Schedule(const TimePoint due, Callback callback) {
+    const TimerId id = next_id_++;
+    callbacks_.emplace(id, std::move(callback));
+    heap_.push(Entry{due, id});
+    return id;
+  }
+
+  // Returns false if the timer already ran or was cancelled.
+  bool Cancel(const TimerId id) { return callbacks_.erase(id) != 0; }
+
+  // Runs every callback due at or before now, earliest first and in the order they were
+  // scheduled for equal times. Callbacks may schedule or cancel timers, ones that are already
+  // due run in the same call. Returns the number of callbacks run.
+  int RunDue(const TimePoint now) {
+    int num_run = 0;
+    while (!heap_.empty() && heap_.top().due <= now) {
+      const TimerId id = heap_.top().id;
+      heap_.pop();
+      auto itr = callbacks_.find(id);
+      if (itr == callbacks_.end()) {
+        continue;  // Cancelled.
+      }
+      const auto callback = std::move(itr->second);
+      callbacks_.erase(itr);
+      callback();
+      ++num_run;
+    }
+    return num_run;
+  }
+
+  [[nodiscard]] std::optional<TimePoint> GetNextDue() {
+    DropCancelled();
+    if (heap_.empty()) {
+      return std::nullopt;
+    }
+    return heap_.top().due;
+  }
+
+  [[nodiscard]] size_t GetNumPending() const { return callbacks_.size(); }
+
+  void Clear() {
+    heap_ = {};
+    callbacks_.clear();
+  }
+
+ private:
+  struct Entry {
+    TimePoint due;
+    TimerId id;
+  };
+
+  struct Later {
+    bool operator()(const Entry& lhs, const Entry& rhs) const {
+      return lhs.due != rhs.due ? lhs.due > rhs.due : lhs.id > rhs.id;
+    }
+  };
+
+  void DropCancelled() {
+    while (!heap_.empty() && callbacks_.count(heap_.top().id) == 0) {
+      heap_.pop();
+    }
+  }
+
+  std::priority_queue<Entry, std::vector<Entry>, Later> heap_;
+  std::unordered_map<TimerId, Callback> callbacks_;
+  TimerId next_id_{1};
+};
+
+}  // namespace platformer
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "utils/check.h"
+
+namespace platformer {
+
+// A single long lived thread that runs one task at a time.
+// Exceptions thrown by the task (e.g. a failed RB_CHECK) are rethrown by Wait().
+class WorkerThread {
+ public:
+  WorkerThread() : thread_{[this] { Run(); }} {}
+
+  ~WorkerThread() {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stop_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+  }
+
+  WorkerThread(const WorkerThread&) = delete;
+  WorkerThread& operator=(const WorkerThread&) = delete;
+
+  // Only one task may be in flight, call Wait() before submitting the next one.
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      RB_CHECK(!task_);
+      task_ = std::move(task);
+    }
+    condition_.notify_all();
+  }
+
+  // Blocks until the current task (if any) has finished.
+  void Wait() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    condition_.wait(lock, [this] { return !task_; });
+    if (exception_) {
+      std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+  }
+
+  [[nodiscard]] bool Busy() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return static_cast<bool>(task_);
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+      condition_.wait(lock, [this] { return stop_ || task_; });
+      if (stop_) {
+        return;
+      }
+      auto task = task_;
+      lock.unlock();
+      std::exception_ptr exception;
+      try {
+        task();
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      lock.lock();
+      exception_ = exception;
+      task_ = nullptr;
+      condition_.notify_all();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::function<void()> task_;
+  std::exception_ptr exception_;
+  bool stop_{false};
+  std::thread thread_;  // Declared last, it is started in the constructor.
+};
+
+}  // namespace platformer
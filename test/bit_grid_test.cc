@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+
+#include "common_types/bit_grid.h"
+#include "common_types/grid.h"
+
+using platformer::BitGrid;
+using platformer::Grid;
+
+TEST_CASE("BitGrid matches the grid it was built from") {
+  Grid<int> grid{150, 7};
+  for (int y = 0; y < grid.GetHeight(); ++y) {
+    for (int x = 0; x < grid.GetWidth(); ++x) {
+      grid.SetTile(x, y, (x * 7 + y * 3) % 5 == 0 ? 1 : 2);
+    }
+  }
+  const auto bit_grid = BitGrid::FromGrid(grid, 1);
+  REQUIRE_EQ(bit_grid.GetWidth(), 150);
+  REQUIRE_EQ(bit_grid.GetHeight(), 7);
+  for (int y = 0; y < grid.GetHeight(); ++y) {
+    for (int x = 0; x < grid.GetWidth(); ++x) {
+      CHECK_EQ(bit_grid.Get(x, y), grid.GetTile(x, y) == 1);
+    }
+  }
+  CHECK_FALSE(bit_grid.Get(-1, 0));
+  CHECK_FALSE(bit_grid.Get(0, 7));
+}
+
+TEST_CASE("BitGrid span queries") {
+  BitGrid grid{200, 100};
+  grid.Set(63, 3, true);
+  grid.Set(150, 3, true);
+  grid.Set(10, 80, true);
+
+  CHECK(grid.AnyInRow(3, 63, 63));
+  CHECK(grid.AnyInRow(3, 0, 199));
+  CHECK_FALSE(grid.AnyInRow(3, 0, 62));
+  CHECK_FALSE(grid.AnyInRow(3, 64, 149));
+  CHECK(grid.AnyInRow(3, 64, 150));
+  CHECK(grid.AnyInRow(3, 140, 500));
+  CHECK_FALSE(grid.AnyInRow(3, 151, 500));
+  CHECK_FALSE(grid.AnyInRow(4, 0, 199));
+  CHECK_FALSE(grid.AnyInRow(-1, 0, 199));
+
+  CHECK(grid.AnyInColumn(10, 0, 99));
+  CHECK(grid.AnyInColumn(10, 80, 200));
+  CHECK_FALSE(grid.AnyInColumn(10, 81, 200));
+  CHECK_FALSE(grid.AnyInColumn(10, -10, 79));
+  CHECK_FALSE(grid.AnyInColumn(300, 0, 99));
+
+  grid.Set(63, 3, false);
+  CHECK_FALSE(grid.AnyInRow(3, 0, 149));
+}
@@ -0,0 +1,111 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/blitter.h"
+#include "rendering/sprite_spans.h"
+
+namespace {
+
+using namespace platformer;
+
+std::vector<const BlitKernels*> GetSupportedKernels() {
+  std::vector<const BlitKernels*> supported;
+  for (const auto instruction_set :
+       {BlitInstructionSet::kScalar, BlitInstructionSet::kSse2, BlitInstructionSet::kAvx2}) {
+    if (const auto* kernels = GetBlitKernels(instruction_set)) {
+      supported.push_back(kernels);
+    }
+  }
+  return supported;
+}
+
+std::vector<olc::Pixel> RandomPixels(std::mt19937& rng, const int count) {
+  std::uniform_int_distribution<int> byte{0, 255};
+  std::vector<olc::Pixel> pixels(count);
+  for (auto& pixel : pixels) {
+    pixel = olc::Pixel(byte(rng), byte(rng), byte(rng), byte(rng));
+  }
+  return pixels;
+}
+
+}  // namespace
+
+TEST_CASE("Blit kernels match the engine's ALPHA pixel mode") {
+  REQUIRE(GetBlitKernels(BlitInstructionSet::kScalar) != nullptr);
+  std::mt19937 rng{7};
+  olc::PixelGameEngine engine;
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  for (const auto* kernels : GetSupportedKernels()) {
+    // Lengths around the vector widths, to cover the tails.
+    for (int count = 0; count < 40; ++count) {
+      const auto source = RandomPixels(rng, count);
+      const auto background = RandomPixels(rng, count);
+      olc::Sprite expected{std::max(count, 1), 1};
+      std::copy(background.begin(), background.end(), expected.GetData());
+      engine.SetDrawTarget(&expected);
+      for (int i = 0; i < count; ++i) {
+        engine.Draw(i, 0, source[i]);
+      }
+      auto actual = background;
+      kernels->blend(source.data(), actual.data(), count);
+      CHECK(std::equal(actual.begin(), actual.end(), expected.GetData()));
+
+      std::copy(background.begin(), background.end(), expected.GetData());
+      for (int i = 0; i < count; ++i) {
+        engine.Draw(i, 0, source[count - 1 - i]);
+      }
+      actual = background;
+      kernels->blend_reversed(source.data(), actual.data(), count);
+      CHECK(std::equal(actual.begin(), actual.end(), expected.GetData()));
+
+      kernels->copy(source.data(), actual.data(), count);
+      CHECK(std::equal(actual.begin(), actual.end(), source.begin()));
+      kernels->copy_reversed(source.data(), actual.data(), count);
+      CHECK(std::equal(actual.begin(), actual.end(), source.rbegin()));
+    }
+  }
+}
+
+TEST_CASE("Sprites drawn with every kernel set match DrawSprite") {
+  std::mt19937 rng{11};
+  olc::Sprite sprite{37, 13};
+  const auto pixels = RandomPixels(rng, 37 * 13);
+  std::copy(pixels.begin(), pixels.end(), sprite.GetData());
+  // Some opaque and transparent runs.
+  for (int i = 0; i < 37 * 13; i += 3) {
+    sprite.GetData()[i].a = i % 2 == 0 ? 0 : 255;
+  }
+  const SpriteSpans spans{sprite};
+  REQUIRE(spans.GetOpacity() == SpriteOpacity::kTrueAlpha);
+
+  olc::PixelGameEngine engine;
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  const auto background = RandomPixels(rng, 64 * 32);
+  for (const auto* kernels : GetSupportedKernels()) {
+    for (const auto flip : {olc::Sprite::Flip::NONE, olc::Sprite::Flip::HORIZ,
+                            olc::Sprite::Flip::VERT}) {
+      for (const auto& [x, y] : std::vector<std::pair<int, int>>{{5, 3}, {-9, -2}, {40, 25}}) {
+        olc::Sprite expected{64, 32};
+        olc::Sprite actual{64, 32};
+        for (auto* target : {&expected, &actual}) {
+          std::copy(background.begin(), background.end(), target->GetData());
+        }
+        engine.SetDrawTarget(&expected);
+        engine.DrawSprite(x, y, &sprite, 1, flip);
+        DrawSpans(sprite, spans, x, y, flip, actual, *kernels);
+        // Transparent pixels leave the background's alpha, the engine sets it to 255.
+        int num_mismatches = 0;
+        for (int i = 0; i < 64 * 32; ++i) {
+          const auto& lhs = expected.GetData()[i];
+          const auto& rhs = actual.GetData()[i];
+          num_mismatches += lhs.r != rhs.r || lhs.g != rhs.g || lhs.b != rhs.b;
+        }
+        CHECK_EQ(num_mismatches, 0);
+      }
+    }
+  }
+}
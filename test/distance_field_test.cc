@@ -0,0 +1,67 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "common_types/bit_grid.h"
+#include "common_types/distance_field.h"
+#include "common_types/ray_casting.h"
+
+using platformer::BitGrid;
+using platformer::DistanceField;
+using platformer::Vector2d;
+
+namespace {
+
+BitGrid MakeScatteredGrid() {
+  BitGrid grid{40, 30};
+  for (int i = 0; i < 25; ++i) {
+    grid.Set((i * 17) % 40, (i * 11) % 30, true);
+  }
+  return grid;
+}
+
+}  // namespace
+
+TEST_CASE("DistanceField holds the Chebyshev distance to the nearest solid tile") {
+  const auto grid = MakeScatteredGrid();
+  const DistanceField field{grid};
+  for (int y = 0; y < grid.GetHeight(); ++y) {
+    for (int x = 0; x < grid.GetWidth(); ++x) {
+      int expected = DistanceField::kMaxDistance;
+      for (int solid_y = 0; solid_y < grid.GetHeight(); ++solid_y) {
+        for (int solid_x = 0; solid_x < grid.GetWidth(); ++solid_x) {
+          if (grid.Get(solid_x, solid_y)) {
+            expected = std::min(expected, std::max(std::abs(x - solid_x), std::abs(y - solid_y)));
+          }
+        }
+      }
+      CHECK_EQ(field.GetDistance(x, y), expected);
+      CHECK_EQ(field.IsSolid(x, y), grid.Get(x, y));
+    }
+  }
+  CHECK_EQ(field.GetDistance(-1, 3), 0);
+  CHECK_EQ(field.GetFreeDistance(-0.5, 3.), 0.);
+}
+
+TEST_CASE("DistanceField saturates without solid tiles") {
+  const DistanceField field{BitGrid{300, 2}};
+  CHECK_EQ(field.GetDistance(0, 0), DistanceField::kMaxDistance);
+  CHECK_EQ(field.GetDistance(299, 1), DistanceField::kMaxDistance);
+}
+
+TEST_CASE("DistanceField line of sight matches walking the tiles") {
+  const auto grid = MakeScatteredGrid();
+  const DistanceField field{grid};
+  const auto is_solid = [&grid](const int x, const int y) { return grid.Get(x, y); };
+  for (int i = 0; i < 500; ++i) {
+    const Vector2d from{0.5 + (i * 7) % 39, 0.5 + (i * 3) % 29};
+    const Vector2d to{0.25 + (i * 13) % 39, 0.75 + (i * 5) % 29};
+    if (grid.Get(static_cast<int>(from.x), static_cast<int>(from.y))) {
+      CHECK_FALSE(field.HasLineOfSight(from, to));
+      continue;
+    }
+    const bool expected = !platformer::FindFirstSolidCrossing(from, to - from, is_solid);
+    CHECK_EQ(field.HasLineOfSight(from, to), expected);
+  }
+}
@@ -0,0 +1,151 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/sprite_spans.h"
+#include "utils/job_system.h"
+
+namespace {
+
+using namespace platformer;
+
+olc::Sprite RandomSprite(std::mt19937& rng, const int width, const int height) {
+  std::uniform_int_distribution<int> byte{0, 255};
+  std::uniform_int_distribution<int> alpha{0, 3};
+  olc::Sprite sprite{width, height};
+  for (int i = 0; i < width * height; ++i) {
+    // Mostly transparent or opaque, like real sprites.
+    const int a = alpha(rng);
+    sprite.GetData()[i] =
+        olc::Pixel(byte(rng), byte(rng), byte(rng), a == 0 ? 0 : a == 1 ? byte(rng) : 255);
+  }
+  return sprite;
+}
+
+bool SamePixels(const olc::Sprite& lhs, const olc::Sprite& rhs) {
+  return std::equal(lhs.pColData.begin(), lhs.pColData.end(), rhs.pColData.begin());
+}
+
+}  // namespace
+
+TEST_CASE("Banded replays match the serial replay") {
+  constexpr int kWidth = 96;
+  constexpr int kHeight = 61;
+  std::mt19937 rng{3};
+  std::vector<olc::Sprite> sprites;
+  sprites.push_back(RandomSprite(rng, 17, 9));
+  sprites.push_back(RandomSprite(rng, 40, 33));
+  sprites.push_back(RandomSprite(rng, 128, 80));
+  std::vector<SpriteSpans> spans;
+  for (const auto& sprite : sprites) {
+    spans.emplace_back(sprite);
+  }
+
+  // Copies a diagonal of the target into its top row. It reads what was drawn before it, so it
+  // only gives the same result if it runs in order.
+  olc::Sprite* target = nullptr;
+  const auto copy_diagonal = [&target] {
+    for (int x = 0; x < target->width; ++x) {
+      target->SetPixel(x, 0, target->GetPixel(x, x % target->height));
+    }
+  };
+
+  DrawCommandList commands;
+  std::uniform_int_distribution<int> pick{0, 9};
+  std::uniform_int_distribution<int> coordinate{-50, 110};
+  commands.Fill(olc::Pixel(10, 20, 30));
+  for (int i = 0; i < 200; ++i) {
+    const int kind = pick(rng);
+    const int x = coordinate(rng);
+    const int y = coordinate(rng);
+    if (kind < 6) {
+      const int index = kind % 3;
+      const auto flip = static_cast<olc::Sprite::Flip>(pick(rng) % 3);
+      commands.DrawSpans(sprites[index].GetData(), spans[index], x, y, flip);
+    } else if (kind < 9) {
+      commands.DrawPoint(x, y, olc::Pixel(x & 255, y & 255, 7));
+    } else {
+      commands.RunSerial(copy_diagonal);
+    }
+  }
+  commands.RunSerial(copy_diagonal);
+  commands.DrawPoint(5, 5, olc::RED);
+
+  olc::Sprite expected{kWidth, kHeight};
+  target = &expected;
+  commands.Replay(expected);
+
+  for (const int num_workers : {0, 3}) {
+    JobSystem job_system{num_workers};
+    for (const int num_bands : {1, 2, 7, kHeight, 100}) {
+      olc::Sprite actual{kWidth, kHeight};
+      target = &actual;
+      commands.ReplayBanded(actual, num_bands, job_system);
+      CHECK(SamePixels(expected, actual));
+    }
+  }
+}
+
+TEST_CASE("Replaying recorded spans matches drawing them directly") {
+  std::mt19937 rng{5};
+  auto sprite = RandomSprite(rng, 23, 31);
+  const SpriteSpans spans{sprite};
+  olc::Sprite expected{50, 40};
+  olc::Sprite actual{50, 40};
+  DrawCommandList commands;
+  commands.Fill(olc::Pixel(0, 0, 255));
+  std::fill(expected.pColData.begin(), expected.pColData.end(), olc::Pixel(0, 0, 255));
+  for (const auto& [x, y] : std::vector<std::pair<int, int>>{{3, 4}, {-10, 20}, {40, -7}}) {
+    DrawSpans(sprite, spans, x, y, olc::Sprite::Flip::HORIZ, expected);
+    commands.DrawSpans(sprite.GetData(), spans, x, y, olc::Sprite::Flip::HORIZ);
+  }
+  commands.DrawPoint(-1, 0, olc::RED);
+  commands.DrawPoint(49, 39, olc::RED);
+  expected.SetPixel(49, 39, olc::RED);
+  CHECK_EQ(commands.GetNumCommands(), 5);
+
+  commands.Replay(actual);
+  CHECK(SamePixels(expected, actual));
+
+  commands.Clear();
+  CHECK_EQ(commands.GetNumCommands(), 0);
+}
+
+TEST_CASE("Repeated images match drawing every copy") {
+  constexpr int kWidth = 70;
+  constexpr int kHeight = 45;
+  std::mt19937 rng{11};
+  auto image = RandomSprite(rng, 16, 12);
+  for (auto& pixel : image.pColData) {
+    pixel.a = 255;
+  }
+  const SpriteSpans spans{image};
+
+  // Wrapping around the target's edges, and copies that do not reach the end of the target.
+  for (const auto& [x, y, num_x, num_y] : std::vector<std::tuple<int, int, int, int>>{
+           {0, 0, 5, 4}, {-7, -3, 5, 5}, {-15, 20, 6, 1}, {9, -11, 2, 3}, {80, 0, 1, 1}}) {
+    olc::Sprite expected{kWidth, kHeight};
+    for (int i = 0; i < num_y; ++i) {
+      for (int j = 0; j < num_x; ++j) {
+        DrawSpans(image, spans, x + j * image.width, y + i * image.height,
+                  olc::Sprite::Flip::NONE, expected);
+      }
+    }
+    DrawCommandList commands;
+    commands.CopyImageRepeated(image, x, y, num_x, num_y);
+
+    olc::Sprite actual{kWidth, kHeight};
+    commands.Replay(actual);
+    CHECK(SamePixels(expected, actual));
+
+    JobSystem job_system{2};
+    olc::Sprite banded{kWidth, kHeight};
+    commands.ReplayBanded(banded, 7, job_system);
+    CHECK(SamePixels(expected, banded));
+  }
+}
@@ -0,0 +1,36 @@
+#include <doctest/doctest.h>
+
+#include <chrono>
+
+#include "utils/chrono_helpers.h"
+#include "utils/frame_pacer.h"
+
+TEST_CASE("PeriodStatistics") {
+  using std::chrono::microseconds;
+  platformer::PeriodStatistics statistics{microseconds(10000)};
+  CHECK_EQ(statistics.Get().num_samples, 0);
+
+  statistics.AddSample(microseconds(9900));
+  statistics.AddSample(microseconds(10100));
+  statistics.AddSample(microseconds(10300));
+  statistics.AddSample(microseconds(9700));
+
+  const auto stats = statistics.Get();
+  CHECK_EQ(stats.num_samples, 4);
+  CHECK_EQ(stats.target_period_us, doctest::Approx(10000));
+  CHECK_EQ(stats.mean_period_us, doctest::Approx(10000));
+  CHECK_EQ(stats.min_period_us, doctest::Approx(9700));
+  CHECK_EQ(stats.max_period_us, doctest::Approx(10300));
+  CHECK_EQ(stats.max_abs_error_us, doctest::Approx(300));
+  CHECK_EQ(stats.stddev_period_us, doctest::Approx(223.607).epsilon(1e-3));
+}
+
+TEST_CASE("FramePacer never wakes before the deadline") {
+  platformer::FramePacer pacer{};
+  for (int i = 0; i < 5; ++i) {
+    const auto deadline = platformer::Clock::now() + std::chrono::microseconds(1500);
+    pacer.WaitUntil(deadline);
+    CHECK(platformer::Clock::now() >= deadline);
+  }
+  CHECK(pacer.GetSleepMargin() > platformer::Duration::zero());
+}
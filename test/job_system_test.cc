@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "registry.h"
+#include "registry_parallel.h"
+#include "utils/job_system.h"
+
+TEST_CASE("ParallelFor visits every index exactly once") {
+  for (const int num_workers : {0, 1, 3}) {
+    platformer::JobSystem job_system{num_workers};
+    std::vector<int> visits(1000, 0);
+    job_system.ParallelFor(0, static_cast<int>(visits.size()), [&](int i) { visits[i]++; });
+    CHECK_EQ(std::accumulate(visits.begin(), visits.end(), 0), 1000);
+    CHECK_EQ(*std::min_element(visits.begin(), visits.end()), 1);
+  }
+}
+
+TEST_CASE("ParallelForRange respects the grain size") {
+  platformer::JobSystem job_system{2};
+  std::mutex chunks_mutex;
+  std::vector<std::pair<int, int>> chunks;
+  job_system.ParallelForRange(
+      0, 1000,
+      [&](int begin, int end) {
+        std::lock_guard<std::mutex> lock{chunks_mutex};
+        chunks.emplace_back(begin, end);
+      },
+      100);
+  std::sort(chunks.begin(), chunks.end());
+
+  REQUIRE(chunks.size() > 1);
+  // The chunks cover the range exactly once, all but the last are at least a grain long.
+  CHECK_EQ(chunks.front().first, 0);
+  CHECK_EQ(chunks.back().second, 1000);
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (i + 1 < chunks.size()) {
+      CHECK_EQ(chunks[i].second, chunks[i + 1].first);
+      CHECK(chunks[i].second - chunks[i].first >= 100);
+    }
+    CHECK(chunks[i].first < chunks[i].second);
+  }
+}
+
+TEST_CASE("TaskGroup supports nesting and rethrows exceptions") {
+  platformer::JobSystem job_system{2};
+  std::atomic<int> sum{0};
+  platformer::TaskGroup group{job_system};
+  for (int i = 0; i < 8; ++i) {
+    group.Run([&] { job_system.ParallelFor(0, 100, [&](int) { sum++; }); });
+  }
+  group.Wait();
+  CHECK_EQ(sum.load(), 800);
+
+  platformer::TaskGroup failing_group{job_system};
+  failing_group.Run([] { throw std::runtime_error("job failed"); });
+  CHECK_THROWS_AS(failing_group.Wait(), std::runtime_error);
+}
+
+TEST_CASE("ParallelForEach over registry components") {
+  platformer::JobSystem job_system{2};
+  platformer::Registry registry{};
+  for (int i = 0; i < 1000; ++i) {
+    registry.AddComponents(platformer::Velocity{},
+                           platformer::Acceleration{static_cast<double>(i), 1.0});
+  }
+  platformer::ParallelForEach<platformer::Acceleration, platformer::Velocity>(
+      job_system, registry,
+      [](platformer::EntityId, const platformer::Acceleration& acc, platformer::Velocity& vel) {
+        vel.x = acc.x;
+      },
+      16);
+  for (const auto id : registry.GetView<platformer::Velocity>()) {
+    CHECK_EQ(registry.GetComponent<platformer::Velocity>(id).x,
+             registry.GetComponent<platformer::Acceleration>(id).x);
+  }
+}
@@ -0,0 +1,104 @@
+#include <doctest/doctest.h>
+
+#include <memory>
+
+#include "common_types/game_configuration.h"
+#include "systems/particle_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+#include "utils/random_number_generator.h"
+
+namespace {
+
+using namespace platformer;
+
+// A floor at y = 0 and a wall at x = 20.
+Level MakeTestLevel() {
+  Level level{};
+  level.property_grid = Grid<int>(32, 16);
+  for (int x = 0; x < 32; ++x) {
+    level.property_grid.SetTile(x, 0, kSolidProperty);
+  }
+  for (int y = 0; y < 16; ++y) {
+    level.property_grid.SetTile(20, y, kSolidProperty);
+  }
+  return level;
+}
+
+std::shared_ptr<ParameterServer> MakeParameterServer() {
+  auto parameter_server = std::make_shared<ParameterServer>();
+  parameter_server->AddParameter("physics/gravity", 50., "");
+  return parameter_server;
+}
+
+}  // namespace
+
+TEST_CASE("Particles fall, stop at solid tiles and expire") {
+  ParticleSystem particles{MakeTestLevel(), MakeParameterServer(),
+                           std::make_shared<RandomNumberGenerator>(),
+                           std::make_shared<JobSystem>(2)};
+  // Fast enough to cross the wall within one step.
+  REQUIRE(particles.Emit(Vector2d{18.5, 8.5}, Vector2d{200., 0.}, olc::WHITE, 0.8));
+  REQUIRE(particles.Emit(Vector2d{5.5, 8.5}, Vector2d{0., 0.}, olc::RED, 0.3));
+
+  particles.Update(0.05);
+  ParticleSnapshot snapshot;
+  particles.Capture(snapshot);
+  REQUIRE_EQ(snapshot.x.size(), 2);
+  CHECK(snapshot.x[0] < 20.f);
+  CHECK(snapshot.x[0] > 19.9f);
+  CHECK(snapshot.y[1] < 8.5f);
+
+  for (int i = 0; i < 14; ++i) {
+    particles.Update(0.05);
+  }
+  // The first one has landed on the floor, the second one has expired.
+  particles.Capture(snapshot);
+  REQUIRE_EQ(snapshot.x.size(), 1);
+  CHECK(snapshot.y[0] >= 1.f);
+  CHECK(snapshot.y[0] < 1.01f);
+  CHECK(snapshot.color[0] == olc::WHITE);
+
+  particles.Update(0.05);
+  particles.Update(0.05);
+  CHECK_EQ(particles.GetNumParticles(), 0);
+}
+
+TEST_CASE("Particle pool is bounded") {
+  auto parameter_server = MakeParameterServer();
+  ParticleSystem particles{MakeTestLevel(), parameter_server,
+                           std::make_shared<RandomNumberGenerator>(),
+                           std::make_shared<JobSystem>(0)};
+  parameter_server->SetParameter<double>("particles/max.count", 100.);
+  particles.SpawnRicochets(
+      std::vector<Ricochet>(30, Ricochet{1, Position{10., 5.}, Velocity{-3., 2.}}));
+  CHECK_EQ(particles.GetNumParticles(), 100);
+
+  particles.Clear();
+  CHECK_EQ(particles.GetNumParticles(), 0);
+}
+
+TEST_CASE("Many particles update in parallel") {
+  ParticleSystem particles{MakeTestLevel(), MakeParameterServer(),
+                           std::make_shared<RandomNumberGenerator>(),
+                           std::make_shared<JobSystem>(3)};
+  for (int i = 0; i < 100000; ++i) {
+    const double x = 1. + (i % 180) * 0.1;
+    const double y = 1.5 + (i % 130) * 0.1;
+    REQUIRE(particles.Emit(Vector2d{x, y}, Vector2d{(i % 11) - 5., (i % 7) - 3.}, olc::WHITE,
+                           0.1 + (i % 10) * 0.1));
+  }
+  for (int i = 0; i < 60; ++i) {
+    particles.Update(1. / 60.);
+  }
+  ParticleSnapshot snapshot;
+  particles.Capture(snapshot);
+  REQUIRE(!snapshot.x.empty());
+  for (size_t i = 0; i < snapshot.x.size(); ++i) {
+    REQUIRE(snapshot.x[i] < 20.f);
+    // Nothing stops them outside of the level.
+    if (snapshot.x[i] >= 0.f) {
+      REQUIRE(snapshot.y[i] >= 1.f);
+    }
+  }
+}
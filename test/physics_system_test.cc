@@ -0,0 +1,273 @@
+#include <doctest/doctest.h>
+
+#include <memory>
+
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "registry.h"
+#include "systems/physics_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+
+namespace {
+
+using namespace platformer;
+
+// A closed room with a few platforms.
+Level MakeTestLevel() {
+  constexpr int kWidth = 64;
+  constexpr int kHeight = 32;
+  Level level{};
+  level.property_grid = Grid<int>(kWidth, kHeight);
+  for (int x = 0; x < kWidth; ++x) {
+    level.property_grid.SetTile(x, 0, 1);
+    level.property_grid.SetTile(x, kHeight - 1, 1);
+  }
+  for (int y = 0; y < kHeight; ++y) {
+    level.property_grid.SetTile(0, y, 1);
+    level.property_grid.SetTile(kWidth - 1, y, 1);
+  }
+  for (int x = 10; x < 50; x += 2) {
+    level.property_grid.SetTile(x, 8 + x % 12, 1);
+  }
+  level.level_tileset = std::make_shared<TileSet>("test", 0, 1, 1, 16);
+  return level;
+}
+
+void PopulateRegistry(Registry& registry) {
+  for (int i = 0; i < 300; ++i) {
+    const double x = 2 + (i * 7) % 58;
+    const double y = 2 + (i * 13) % 26;
+    registry.AddComponents(Position{x, y}, Velocity{(i % 9) - 4.0, (i % 5) - 2.0},
+                           Acceleration{0, -50}, CollisionBox{0, 0, 16, 16}, Collision{});
+  }
+  for (int i = 0; i < 800; ++i) {
+    const double x = 1.5 + (i * 3) % 60;
+    const double y = 1.5 + (i * 11) % 28;
+    registry.AddComponents(Position{x, y}, Velocity{(i % 21) - 10.0, (i % 17) - 8.0},
+                           Acceleration{}, Projectile{}, FacingDirection{Direction::LEFT});
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Parallel physics step matches the serial step") {
+  const auto level = MakeTestLevel();
+  auto serial_registry = std::make_shared<Registry>();
+  auto parallel_registry = std::make_shared<Registry>();
+  PopulateRegistry(*serial_registry);
+  PopulateRegistry(*parallel_registry);
+
+  PhysicsSystem serial_physics{level, std::make_shared<ParameterServer>(),
+                               std::make_shared<JobSystem>(0), serial_registry};
+  PhysicsSystem parallel_physics{level, std::make_shared<ParameterServer>(),
+                                 std::make_shared<JobSystem>(3), parallel_registry};
+
+  size_t num_ricochets = 0;
+  for (int step = 0; step < 20; ++step) {
+    serial_physics.PhysicsStep(0.02);
+    parallel_physics.PhysicsStep(0.02);
+    REQUIRE_EQ(serial_physics.GetRicochets().size(), parallel_physics.GetRicochets().size());
+    num_ricochets += serial_physics.GetRicochets().size();
+  }
+
+  const auto ids = serial_registry->GetView<Position, Velocity>();
+  const auto parallel_ids = parallel_registry->GetView<Position, Velocity>();
+  REQUIRE_EQ(ids, parallel_ids);
+  CHECK(num_ricochets > 0);
+  for (const auto id : ids) {
+    const auto& [serial_pos, serial_vel] =
+        serial_registry->GetComponentsConst<Position, Velocity>(id);
+    const auto& [parallel_pos, parallel_vel] =
+        parallel_registry->GetComponentsConst<Position, Velocity>(id);
+    CHECK_EQ(serial_pos.x, parallel_pos.x);
+    CHECK_EQ(serial_pos.y, parallel_pos.y);
+    CHECK_EQ(serial_vel.x, parallel_vel.x);
+    CHECK_EQ(serial_vel.y, parallel_vel.y);
+  }
+}
+
+TEST_CASE("Fast projectiles bounce off thin walls and hit actors along their path") {
+  auto level = MakeTestLevel();
+  // A one tile thick wall.
+  for (int y = 1; y < 31; ++y) {
+    level.property_grid.SetTile(40, y, 1);
+  }
+  auto registry = std::make_shared<Registry>();
+  const auto projectile =
+      registry->AddComponents(Position{30.5, 4.5}, Velocity{600., 0.}, Projectile{});
+  const auto target = registry->AddComponents(Position{35.2, 20.}, Velocity{},
+                                              CollisionBox{0, 0, 8, 16}, Collision{});
+  const auto bullet =
+      registry->AddComponents(Position{30.5, 20.5}, Velocity{600., 0.}, Projectile{});
+
+  PhysicsSystem physics{level, std::make_shared<ParameterServer>(), std::make_shared<JobSystem>(0),
+                        registry};
+  // The projectiles cover more than 10 tiles per step, several times the width of the wall
+  // and of the target.
+  physics.PhysicsStep(0.25);
+
+  // It bounces back and forth between the walls at x = 0 and x = 40.
+  const auto& position = registry->GetComponentConst<Position>(projectile);
+  CHECK(position.x > 1.);
+  CHECK(position.x < 40.);
+
+  const auto events = physics.DetectProjectileCollisions();
+  REQUIRE_EQ(events.size(), 1);
+  CHECK_EQ(events[0].entity_id, target);
+  CHECK_EQ(events[0].projectile_id, bullet);
+}
+
+TEST_CASE("Projectiles fired from inside the shooter's box do not hit the shooter") {
+  const auto level = MakeTestLevel();
+  auto registry = std::make_shared<Registry>();
+  // The player's collision box, standing on the floor.
+  const auto shooter = registry->AddComponents(Position{20., 1.}, Velocity{},
+                                               CollisionBox{30, 0, 18, 48}, Collision{});
+  // UpShot muzzle at {43, 47} px and a crouch shot muzzle at {40, 20} px, both inside the box.
+  registry->AddComponents(Position{20. + 43. / 16, 1. + 47. / 16}, Velocity{0., 600.},
+                          Projectile{0, shooter});
+  registry->AddComponents(Position{20. + 40. / 16, 1. + 20. / 16}, Velocity{600., 0.},
+                          Projectile{0, shooter});
+
+  PhysicsSystem physics{level, std::make_shared<ParameterServer>(), std::make_shared<JobSystem>(0),
+                        registry};
+  physics.PhysicsStep(0.01);
+  CHECK(physics.DetectProjectileCollisions().empty());
+
+  // Anybody else's shot from the same spot does hit.
+  const auto stray = registry->AddComponents(Position{20. + 40. / 16, 1. + 20. / 16},
+                                             Velocity{600., 0.}, Projectile{});
+  physics.PhysicsStep(0.01);
+  const auto events = physics.DetectProjectileCollisions();
+  REQUIRE_EQ(events.size(), 1);
+  CHECK_EQ(events[0].entity_id, shooter);
+  CHECK_EQ(events[0].projectile_id, stray);
+}
+
+TEST_CASE("Fast actors stop at thin floors and walls") {
+  auto level = MakeTestLevel();
+  // A one tile thick floor and a one tile thick wall.
+  for (int x = 1; x < 63; ++x) {
+    level.property_grid.SetTile(x, 4, 1);
+  }
+  for (int y = 5; y < 31; ++y) {
+    level.property_grid.SetTile(20, y, 1);
+  }
+  auto registry = std::make_shared<Registry>();
+  // 16x16 pixel box, one tile.
+  const auto faller = registry->AddComponents(Position{5., 28.}, Velocity{0., -600.},
+                                              CollisionBox{0, 0, 16, 16}, Collision{});
+  const auto runner = registry->AddComponents(Position{12., 25.}, Velocity{400., 0.},
+                                              CollisionBox{0, 0, 16, 16}, Collision{});
+
+  PhysicsSystem physics{level, std::make_shared<ParameterServer>(), std::make_shared<JobSystem>(0),
+                        registry};
+  // Both would pass through in a single step, by 30 and 20 tiles.
+  physics.PhysicsStep(0.05);
+
+  const auto& [faller_position, faller_collision] =
+      registry->GetComponentsConst<Position, Collision>(faller);
+  CHECK(faller_collision.bottom);
+  CHECK_EQ(faller_position.y, doctest::Approx(5.));
+
+  const auto& [runner_position, runner_collision] =
+      registry->GetComponentsConst<Position, Collision>(runner);
+  CHECK(runner_collision.right);
+  CHECK(runner_position.x < 19.);
+  CHECK(runner_position.x > 18.99);
+}
+
+TEST_CASE("Resting actors fall asleep and wake when pushed") {
+  const auto level = MakeTestLevel();
+  auto registry = std::make_shared<Registry>();
+  const auto actor = registry->AddComponents(Position{3., 1.5}, Velocity{}, Acceleration{},
+                                             CollisionBox{0, 0, 16, 16}, Collision{});
+  auto parameter_server = std::make_shared<ParameterServer>();
+  PhysicsSystem physics{level, parameter_server, std::make_shared<JobSystem>(0), registry};
+  const auto sleep_frames =
+      static_cast<int>(parameter_server->GetParameter<double>("physics/sleep.frames"));
+
+  const auto step = [&] {
+    physics.ApplyGravity();
+    physics.PhysicsStep(0.01);
+  };
+  // Landing takes a few steps.
+  for (int i = 0; i < sleep_frames + 20; ++i) {
+    step();
+  }
+  REQUIRE(physics.IsSleeping(actor));
+  CHECK_EQ(physics.GetNumSleeping(), 1);
+  const auto& position = registry->GetComponentConst<Position>(actor);
+  CHECK_EQ(position.y, doctest::Approx(1.));
+
+  registry->GetComponent<Velocity>(actor).x = 5.;
+  step();
+  CHECK_FALSE(physics.IsSleeping(actor));
+  CHECK(position.x > 3.);
+
+  // Nothing applies friction here.
+  registry->GetComponent<Velocity>(actor).x = 0.;
+  for (int i = 0; i < sleep_frames + 100; ++i) {
+    step();
+  }
+  REQUIRE(physics.IsSleeping(actor));
+  physics.WakeRegion(BoundingBox{0., 10., 0., 10.});
+  CHECK_FALSE(physics.IsSleeping(actor));
+}
+
+TEST_CASE("Raycasts and region queries against tiles and actors") {
+  const auto level = MakeTestLevel();
+  auto registry = std::make_shared<Registry>();
+  const auto near = registry->AddComponents(Position{20., 4.}, Velocity{},
+                                            CollisionBox{0, 0, 16, 16}, Collision{});
+  const auto far = registry->AddComponents(Position{30., 4.}, Velocity{},
+                                           CollisionBox{0, 0, 16, 16}, Collision{});
+  PhysicsSystem physics{level, std::make_shared<ParameterServer>(), std::make_shared<JobSystem>(2),
+                        registry};
+  // Fills in the broadphase.
+  physics.PhysicsStep(0.);
+
+  const Ray ray{Vector2d{2., 4.5}, Vector2d{70., 4.5}};
+  const auto hit = physics.Raycast(ray);
+  REQUIRE(hit.has_value());
+  CHECK_EQ(hit->entity_id, near);
+  CHECK_EQ(hit->t, doctest::Approx(18. / 68.));
+  CHECK_EQ(hit->point.x, doctest::Approx(20.));
+
+  const auto ignoring_near = physics.Raycast(Ray{ray.start, ray.end, near});
+  REQUIRE(ignoring_near.has_value());
+  CHECK_EQ(ignoring_near->entity_id, far);
+
+  const auto tiles_only = physics.Raycast(Ray{ray.start, ray.end, 0, true, false});
+  REQUIRE(tiles_only.has_value());
+  CHECK_EQ(tiles_only->entity_id, 0);
+  CHECK_EQ(tiles_only->point.x, doctest::Approx(63.));
+
+  CHECK_FALSE(physics.Raycast(Ray{ray.start, Vector2d{10., 4.5}}).has_value());
+  const auto from_inside_wall = physics.Raycast(Ray{Vector2d{0.5, 4.5}, ray.end});
+  REQUIRE(from_inside_wall.has_value());
+  CHECK_EQ(from_inside_wall->t, 0.);
+
+  const std::vector<Ray> rays{ray, Ray{ray.start, ray.end, near}, Ray{ray.start, ray.end, 0, true,
+                                                                      false}};
+  const auto hits = physics.RaycastBatch(rays);
+  REQUIRE_EQ(hits.size(), rays.size());
+  for (size_t i = 0; i < rays.size(); ++i) {
+    const auto expected = physics.Raycast(rays[i]);
+    REQUIRE(hits[i].has_value());
+    CHECK_EQ(hits[i]->entity_id, expected->entity_id);
+    CHECK_EQ(hits[i]->t, expected->t);
+  }
+
+  CHECK_EQ(physics.QueryAabb(BoundingBox{19.5, 30.5, 3., 6.}), (std::vector<EntityId>{near, far}));
+  // Only touching does not count.
+  CHECK(physics.QueryAabb(BoundingBox{21., 30., 3., 6.}).empty());
+
+  CHECK(physics.IsAreaFree(BoundingBox{2., 3., 1., 2.}));
+  CHECK_FALSE(physics.IsAreaFree(BoundingBox{2., 3., 0.5, 2.}));
+
+  CHECK(physics.NearestEntity(Vector2d{25., 4.5}, 10.) == near);
+  CHECK(physics.NearestEntity(Vector2d{25., 4.5}, 10., near) == far);
+  CHECK_FALSE(physics.NearestEntity(Vector2d{25., 4.5}, 3.).has_value());
+}
@@ -0,0 +1,86 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/primitive_batch.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kWidth = 30;
+constexpr int kHeight = 20;
+
+// Draws the primitives through the engine, one pixel at a time.
+olc::Sprite DrawWithEngine(const std::vector<Primitive>& primitives) {
+  olc::PixelGameEngine engine;
+  olc::Sprite target{kWidth, kHeight};
+  engine.SetDrawTarget(&target);
+  for (const auto& primitive : primitives) {
+    engine.Draw(primitive.x, primitive.y, primitive.color);
+    if (primitive.shape == PrimitiveShape::kPlus) {
+      engine.Draw(primitive.x + 1, primitive.y, primitive.color);
+      engine.Draw(primitive.x, primitive.y + 1, primitive.color);
+      engine.Draw(primitive.x - 1, primitive.y, primitive.color);
+      engine.Draw(primitive.x, primitive.y - 1, primitive.color);
+    }
+  }
+  return target;
+}
+
+std::vector<Primitive> MakeRandomPrimitives(const int num_primitives) {
+  // Some of them off the target or on its border.
+  std::mt19937 rng{7};
+  std::uniform_int_distribution<int> x{-3, kWidth + 2};
+  std::uniform_int_distribution<int> y{-3, kHeight + 2};
+  std::vector<Primitive> primitives;
+  for (int i = 0; i < num_primitives; ++i) {
+    const auto shape = i % 3 == 0 ? PrimitiveShape::kPoint : PrimitiveShape::kPlus;
+    primitives.push_back(Primitive{x(rng), y(rng), olc::Pixel(i, 255 - i, 7 * i), shape});
+  }
+  return primitives;
+}
+
+bool Equal(const olc::Sprite& lhs, const olc::Sprite& rhs) {
+  return std::equal(lhs.pColData.begin(), lhs.pColData.end(), rhs.pColData.begin());
+}
+
+}  // namespace
+
+TEST_CASE("Primitives match drawing them through the engine") {
+  const auto primitives = MakeRandomPrimitives(200);
+  const auto expected = DrawWithEngine(primitives);
+
+  olc::Sprite actual{kWidth, kHeight};
+  DrawPrimitives(primitives.data(), static_cast<int>(primitives.size()), actual,
+                 RowRange{0, kHeight});
+  CHECK(Equal(actual, expected));
+}
+
+TEST_CASE("Primitives are clipped to the rows") {
+  const auto primitives = MakeRandomPrimitives(200);
+  const auto expected = DrawWithEngine(primitives);
+
+  // Band by band, including bands that reach past the target.
+  for (const int band_height : {1, 2, 3, 7, 25}) {
+    olc::Sprite actual{kWidth, kHeight};
+    for (int begin = -band_height; begin < kHeight + band_height; begin += band_height) {
+      DrawPrimitives(primitives.data(), static_cast<int>(primitives.size()), actual,
+                     RowRange{begin, begin + band_height});
+    }
+    CHECK(Equal(actual, expected));
+  }
+
+  // Nothing outside of the rows is touched.
+  olc::Sprite actual{kWidth, kHeight};
+  const Primitive plus{5, 10, olc::WHITE, PrimitiveShape::kPlus};
+  DrawPrimitives(&plus, 1, actual, RowRange{10, 11});
+  CHECK(actual.GetPixel(5, 10) == olc::WHITE);
+  CHECK(actual.GetPixel(4, 10) == olc::WHITE);
+  CHECK(actual.GetPixel(6, 10) == olc::WHITE);
+  CHECK(actual.GetPixel(5, 9) != olc::WHITE);
+  CHECK(actual.GetPixel(5, 11) != olc::WHITE);
+}
@@ -0,0 +1,57 @@
+#include <doctest/doctest.h>
+
+#include <memory>
+#include <vector>
+
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "registry.h"
+#include "systems/projectile_system.h"
+#include "utils/parameter_server.h"
+#include "utils/random_number_generator.h"
+
+namespace {
+
+using namespace platformer;
+
+Level MakeTestLevel() {
+  Level level{};
+  level.property_grid = Grid<int>(40, 20);
+  level.level_tileset = std::make_shared<TileSet>("test", 0, 1, 1, 16);
+  return level;
+}
+
+}  // namespace
+
+TEST_CASE("Projectiles are removed once expired") {
+  auto registry = std::make_shared<Registry>();
+  auto parameter_server = std::make_shared<ParameterServer>();
+  ProjectileSystem projectiles{parameter_server, nullptr, std::make_shared<RandomNumberGenerator>(),
+                               registry, MakeTestLevel()};
+  parameter_server->SetParameter<double>("projectiles/max.bounces", 2.);
+  parameter_server->SetParameter<double>("projectiles/max.live", 3.);
+
+  std::vector<EntityId> others;
+  for (int i = 0; i < 4; ++i) {
+    others.push_back(registry->AddComponents(Position{10. + i, 5.}, Velocity{}, Projectile{}));
+  }
+  const auto bouncing = registry->AddComponents(Position{5., 5.}, Velocity{}, Projectile{});
+  const auto outside = registry->AddComponents(Position{41., 5.}, Velocity{}, Projectile{});
+
+  projectiles.RemoveExpiredProjectiles({Ricochet{bouncing, Position{}, Velocity{}, 1}});
+  CHECK(registry->HasComponent<Projectile>(bouncing));
+  CHECK_FALSE(registry->HasComponent<Projectile>(outside));
+  // Five left, the two oldest go.
+  CHECK_EQ(registry->GetView<Projectile>(),
+           (std::vector<EntityId>{others[2], others[3], bouncing}));
+
+  parameter_server->SetParameter<double>("projectiles/max.live", 10.);
+  const auto bouncing_again =
+      registry->AddComponents(Position{5., 5.}, Velocity{}, Projectile{});
+  projectiles.RemoveExpiredProjectiles({Ricochet{bouncing_again, Position{}, Velocity{}, 2}});
+  CHECK_FALSE(registry->HasComponent<Projectile>(bouncing_again));
+  CHECK_EQ(registry->GetView<Projectile>().size(), 3);
+
+  projectiles.RemoveExpiredProjectiles({Ricochet{bouncing, Position{}, Velocity{}, 1}});
+  CHECK_FALSE(registry->HasComponent<Projectile>(bouncing));
+}
@@ -0,0 +1,63 @@
+#include <doctest/doctest.h>
+
+#include <set>
+#include <utility>
+
+#include "common_types/ray_casting.h"
+
+using platformer::Axis;
+using platformer::BoundingBox;
+using platformer::Vector2d;
+
+TEST_CASE("FindFirstSolidCrossing visits every crossed cell in order") {
+  std::set<std::pair<int, int>> visited;
+  int last_x = 0;
+  const auto crossing = platformer::FindFirstSolidCrossing(
+      Vector2d{0.5, 0.5}, Vector2d{9.0, 3.0}, [&](int x, int y) {
+        CHECK(x >= last_x);
+        last_x = x;
+        visited.emplace(x, y);
+        return false;
+      });
+  CHECK_FALSE(crossing.has_value());
+  // 9 vertical and 3 horizontal boundaries crossed.
+  CHECK_EQ(visited.size(), 12);
+  CHECK(visited.count({9, 3}));
+}
+
+TEST_CASE("FindFirstSolidCrossing does not tunnel through thin walls") {
+  const auto wall_at_x_50 = [](int x, int /*y*/) { return x == 50; };
+  const auto crossing =
+      platformer::FindFirstSolidCrossing(Vector2d{0.5, 2.5}, Vector2d{1000., 1.}, wall_at_x_50);
+  REQUIRE(crossing.has_value());
+  CHECK_EQ(crossing->cell_x, 50);
+  CHECK_EQ(crossing->cell_y, 2);
+  CHECK_EQ(crossing->axis, Axis::X);
+  CHECK_EQ(crossing->t, doctest::Approx(49.5 / 1000.));
+
+  const auto floor_at_y_0 = [](int /*x*/, int y) { return y == 0; };
+  const auto down =
+      platformer::FindFirstSolidCrossing(Vector2d{3.5, 5.5}, Vector2d{0., -10.}, floor_at_y_0);
+  REQUIRE(down.has_value());
+  CHECK_EQ(down->axis, Axis::Y);
+  CHECK_EQ(down->t, doctest::Approx(0.45));
+
+  // The starting cell is never reported.
+  CHECK_FALSE(platformer::FindFirstSolidCrossing(Vector2d{50.5, 2.5}, Vector2d{0.2, 0.},
+                                                 wall_at_x_50)
+                  .has_value());
+}
+
+TEST_CASE("IntersectSegmentAabb") {
+  const BoundingBox box{4., 5., 0., 2.};
+  const auto hit = platformer::IntersectSegmentAabb(Vector2d{0., 1.}, Vector2d{10., 0.}, box);
+  REQUIRE(hit.has_value());
+  CHECK_EQ(*hit, doctest::Approx(0.4));
+  CHECK_FALSE(
+      platformer::IntersectSegmentAabb(Vector2d{0., 3.}, Vector2d{10., 0.}, box).has_value());
+  CHECK_FALSE(
+      platformer::IntersectSegmentAabb(Vector2d{0., 1.}, Vector2d{3., 0.}, box).has_value());
+  const auto inside = platformer::IntersectSegmentAabb(Vector2d{4.5, 1.}, Vector2d{1., 1.}, box);
+  REQUIRE(inside.has_value());
+  CHECK_EQ(*inside, doctest::Approx(0.));
+}
@@ -0,0 +1,226 @@
+// Renders scripted scenes of level 0 into an off-screen framebuffer, without a window, and
+// compares the last frame of each scene with its golden image in test/golden. Prints how long each
+// render pass took on average.
+// Usage: render_harness [--update]
+//   --update  Writes the rendered frames as the new golden images instead of comparing.
+// Exits with 1 if any frame differs from its golden image. The differing frame is then written to
+// <scene>.actual.png in the working directory.
+
+#include <png.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "animation/sprite_manager.h"
+#include "common_types/basic_types.h"
+#include "common_types/components.h"
+#include "config.h"
+#include "global_defs.h"
+#include "load_game_configuration.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+#include "utils/simple_profiler.h"
+
+namespace {
+
+using namespace platformer;
+
+struct Scene {
+  std::string name;
+  int num_sprites;
+  int num_pellets;
+  // The camera moves linearly between the waypoints, in tiles.
+  std::vector<Vector2d> camera_path;
+  int frames_per_waypoint;
+};
+
+const std::vector<Scene> kScenes{
+    {"idle", 10, 0, {{10, 2}}, 60},
+    {"crowd", 300, 0, {{0, 0}, {40, 4}, {80, 0}}, 60},
+    {"pellets", 20, 2000, {{20, 2}, {30, 6}}, 60},
+};
+
+// A diamond with a translucent rim, so drawing it exercises the opaque, translucent and
+// transparent paths of the rasterizer.
+std::unique_ptr<olc::Sprite> MakeDiamondSprite(const int size, const olc::Pixel color) {
+  auto sprite = std::make_unique<olc::Sprite>(size, size);
+  const int half = size / 2;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      const int distance = std::abs(x - half) + std::abs(y - half);
+      const auto alpha = distance < half - 2 ? 255 : distance < half ? 120 : 0;
+      sprite->SetPixel(x, y, olc::Pixel(color.r, color.g, (color.b + 3 * x) & 255, alpha));
+    }
+  }
+  return sprite;
+}
+
+// The positions only depend on the seed, not on the standard library.
+void AddEntities(const Scene& scene, const Level& level, Registry& registry) {
+  std::mt19937 rng{7};
+  const auto random_position = [&] {
+    const double x = static_cast<double>(rng() % (level.tile_grid.GetWidth() * 16)) / 16.;
+    const double y = static_cast<double>(rng() % (level.tile_grid.GetHeight() * 16)) / 16.;
+    return Position{x, y};
+  };
+  for (int i = 0; i < scene.num_sprites; ++i) {
+    registry.AddComponents(random_position(), SpriteComponent{i % 2 == 0 ? "crate" : "ghost"},
+                           FacingDirection{i % 3 == 0 ? Direction::LEFT : Direction::RIGHT});
+  }
+  for (int i = 0; i < scene.num_pellets; ++i) {
+    const auto shape = i % 4 == 0 ? PrimitiveShape::kPoint : PrimitiveShape::kPlus;
+    registry.AddComponents(random_position(), PrimitiveComponent{Rgba{255, 255, 255}, shape});
+  }
+}
+
+bool SavePng(const olc::Sprite& image, const std::filesystem::path& path) {
+  FILE* file = std::fopen(path.string().c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png_create_info_struct(png);
+  if (setjmp(png_jmpbuf(png))) {
+    png_destroy_write_struct(&png, &info);
+    std::fclose(file);
+    return false;
+  }
+  png_init_io(png, file);
+  png_set_IHDR(png, info, image.width, image.height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  // olc::Pixel is laid out as r, g, b, a bytes.
+  for (int y = 0; y < image.height; ++y) {
+    png_write_row(png, reinterpret_cast<png_const_bytep>(image.pColData.data() + y * image.width));
+  }
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  std::fclose(file);
+  return true;
+}
+
+int CountDifferentPixels(const olc::Sprite& lhs, const olc::Sprite& rhs) {
+  if (lhs.width != rhs.width || lhs.height != rhs.height) {
+    return lhs.width * lhs.height;
+  }
+  int num_different = 0;
+  for (size_t i = 0; i < lhs.pColData.size(); ++i) {
+    num_different += lhs.pColData[i] != rhs.pColData[i];
+  }
+  return num_different;
+}
+
+// Renders the scene pass by pass, then its last frame again in one go as the game does.
+// Returns whether that frame matches the golden image.
+bool RunScene(const Scene& scene, const Level& level, const bool update) {
+  const auto source_dir = std::filesystem::path(SOURCE_DIR);
+  auto registry = std::make_shared<Registry>();
+  auto sprite_manager = std::make_shared<SpriteManager>(registry);
+  sprite_manager->AddSprite("crate", 12, 0, MakeDiamondSprite(24, olc::Pixel(200, 120, 40)));
+  sprite_manager->AddSprite("ghost", 8, 0, MakeDiamondSprite(17, olc::Pixel(90, 200, 230)));
+
+  // Never constructed, so there is no window.
+  olc::PixelGameEngine engine;
+  olc::Sprite framebuffer{kScreenWidthPx, kScreenHeightPx};
+  RenderingSystem rendering_system{&engine,
+                                   level,
+                                   std::make_shared<ParameterServer>(),
+                                   sprite_manager,
+                                   registry,
+                                   std::make_shared<JobSystem>(0)};
+  rendering_system.SetRenderTarget(&framebuffer);
+  if (!rendering_system.AddBackgroundLayer(
+          source_dir / "assets" / "backgrounds" / "background.png", 4)) {
+    return false;
+  }
+  AddEntities(scene, level, *registry);
+
+  SimpleProfiler profiler;
+  int num_frames = 0;
+  const auto& path = scene.camera_path;
+  for (size_t waypoint = 0; waypoint < path.size(); ++waypoint) {
+    const auto& from = path[waypoint];
+    const auto& to = path[std::min(waypoint + 1, path.size() - 1)];
+    for (int frame = 0; frame < scene.frames_per_waypoint; ++frame, ++num_frames) {
+      const double ratio = static_cast<double>(frame) / scene.frames_per_waypoint;
+      rendering_system.SetCameraPosition(from + Vector2d{(to.x - from.x) * ratio,
+                                                         (to.y - from.y) * ratio});
+      profiler.Reset();
+      const auto snapshot = rendering_system.CaptureSnapshot();
+      profiler.LogEvent("00_capture");
+      rendering_system.RenderBackground();
+      profiler.LogEvent("01_background");
+      rendering_system.RenderTiles();
+      profiler.LogEvent("02_tiles");
+      rendering_system.RenderEntities(snapshot);
+      profiler.LogEvent("03_entities");
+      rendering_system.RenderForeground();
+      profiler.LogEvent("04_foreground");
+    }
+  }
+  std::cout << scene.name << ": " << num_frames << " frames, " << scene.num_sprites
+            << " sprites, " << scene.num_pellets << " pellets" << std::endl;
+  profiler.PrintTimings();
+
+  const olc::Sprite by_pass = framebuffer;
+  rendering_system.RenderFrame(rendering_system.CaptureSnapshot());
+  if (CountDifferentPixels(by_pass, framebuffer) != 0) {
+    std::cout << "  FAILED: rendering pass by pass differs from rendering the whole frame"
+              << std::endl;
+    return false;
+  }
+
+  const auto golden_file = source_dir / "test" / "golden" / (scene.name + ".png");
+  if (update) {
+    if (!SavePng(framebuffer, golden_file)) {
+      std::cout << "  FAILED: could not write " << golden_file << std::endl;
+      return false;
+    }
+    std::cout << "  wrote " << golden_file << std::endl;
+    return true;
+  }
+  olc::Sprite golden;
+  if (golden.LoadFromFile(golden_file.string()) != olc::rcode::OK) {
+    std::cout << "  FAILED: could not load " << golden_file << ", run with --update to create it"
+              << std::endl;
+    return false;
+  }
+  const int num_different = CountDifferentPixels(golden, framebuffer);
+  if (num_different != 0) {
+    const auto actual_file = scene.name + ".actual.png";
+    SavePng(framebuffer, actual_file);
+    std::cout << "  FAILED: " << num_different << " pixels differ from " << golden_file
+              << ", see " << actual_file << std::endl;
+    return false;
+  }
+  std::cout << "  matches " << golden_file << std::endl;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const bool update = argc > 1 && std::string(argv[1]) == "--update";
+  const auto levels_path = std::filesystem::path(SOURCE_DIR) / "levels.json";
+  const auto config = LoadGameConfiguration(levels_path.string());
+  if (!config.has_value() || config->levels.empty()) {
+    std::cout << "Failed loading " << levels_path << std::endl;
+    return 1;
+  }
+
+  bool success = true;
+  for (const auto& scene : kScenes) {
+    success = RunScene(scene, config->levels.at(0), update) && success;
+  }
+  return success ? 0 : 1;
+}
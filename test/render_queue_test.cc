@@ -0,0 +1,255 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/render_queue.h"
+#include "rendering/sprite_spans.h"
+
+namespace {
+
+using namespace platformer;
+
+olc::Sprite SolidSprite(const int width, const int height, const olc::Pixel color) {
+  olc::Sprite sprite{width, height};
+  std::fill(sprite.pColData.begin(), sprite.pColData.end(), color);
+  return sprite;
+}
+
+}  // namespace
+
+TEST_CASE("The render queue draws by layer, then sort key, then source") {
+  auto red = SolidSprite(4, 4, olc::RED);
+  auto green = SolidSprite(4, 4, olc::GREEN);
+  const SpriteSpans red_spans{red};
+  const SpriteSpans green_spans{green};
+  const auto draw = [](RenderQueue& queue) {
+    olc::Sprite target{4, 4};
+    DrawCommandList commands;
+    queue.Flush(commands);
+    commands.Replay(target);
+    return target.GetPixel(1, 1);
+  };
+  RenderQueue queue;
+
+  // Later layers are drawn on top, whatever the submission order.
+  queue.SubmitSprite(RenderLayer::kForeground, 0, red.GetData(), red_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  queue.SubmitSprite(RenderLayer::kEntities, 0, green.GetData(), green_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  CHECK_EQ(queue.GetNumSubmitted(), 2);
+  CHECK(draw(queue) == olc::RED);
+  CHECK_EQ(queue.GetNumSubmitted(), 0);
+
+  // So are higher sort keys within a layer.
+  queue.SubmitSprite(RenderLayer::kEntities, 1, red.GetData(), red_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  queue.SubmitSprite(RenderLayer::kEntities, 0, green.GetData(), green_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  CHECK(draw(queue) == olc::RED);
+
+  // With equal keys, draws of the same source are batched in the order of first submission: the
+  // second red sprite is drawn before the green one.
+  queue.SubmitSprite(RenderLayer::kEntities, 0, red.GetData(), red_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  queue.SubmitSprite(RenderLayer::kEntities, 0, green.GetData(), green_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  queue.SubmitSprite(RenderLayer::kEntities, 0, red.GetData(), red_spans, 0, 0,
+                     olc::Sprite::Flip::NONE);
+  CHECK(draw(queue) == olc::GREEN);
+
+  // Within a batch, submission order is kept.
+  queue.SubmitPoint(RenderLayer::kEffects, 0, 1, 1, olc::RED);
+  queue.SubmitPoint(RenderLayer::kEffects, 0, 1, 1, olc::GREEN);
+  CHECK(draw(queue) == olc::GREEN);
+}
+
+TEST_CASE("Batched primitives become one draw command each") {
+  RenderQueue queue;
+  for (int i = 0; i < 10; ++i) {
+    queue.SubmitPoint(RenderLayer::kEffects, 0, i, i, olc::WHITE);
+    queue.SubmitLine(RenderLayer::kDebug, 0, 0, i, 5, i, olc::WHITE);
+    queue.SubmitRect(RenderLayer::kBackground, 0, i, 0, 2, 2, olc::WHITE);
+  }
+  DrawCommandList commands;
+  queue.Flush(commands);
+  CHECK_EQ(commands.GetNumCommands(), 3);
+}
+
+TEST_CASE("Primitives submitted together are one submission and draw as if submitted one by one") {
+  const std::vector<Primitive> primitives{{1, 1, olc::RED, PrimitiveShape::kPoint},
+                                          {2, 2, olc::GREEN, PrimitiveShape::kPlus},
+                                          {1, 1, olc::BLUE, PrimitiveShape::kPoint}};
+  const auto draw = [](RenderQueue& queue) {
+    olc::Sprite target{6, 6};
+    DrawCommandList commands;
+    queue.Flush(commands);
+    commands.Replay(target);
+    return target;
+  };
+  RenderQueue queue;
+  for (const auto& primitive : primitives) {
+    queue.SubmitPrimitive(RenderLayer::kEffects, 0, primitive.x, primitive.y, primitive.color,
+                          primitive.shape);
+  }
+  const auto expected = draw(queue);
+
+  queue.SubmitPrimitives(RenderLayer::kEffects, 0, primitives.data(),
+                         static_cast<int>(primitives.size()));
+  CHECK_EQ(queue.GetNumSubmitted(), 1);
+  const auto actual = draw(queue);
+  CHECK(std::equal(expected.pColData.begin(), expected.pColData.end(), actual.pColData.begin()));
+
+  // Together with single primitives of the same key, submission order is kept, in one command.
+  queue.SubmitPoint(RenderLayer::kEffects, 0, 2, 2, olc::WHITE);
+  queue.SubmitPrimitives(RenderLayer::kEffects, 0, primitives.data(),
+                         static_cast<int>(primitives.size()));
+  queue.SubmitPoint(RenderLayer::kEffects, 0, 1, 1, olc::WHITE);
+  DrawCommandList commands;
+  queue.Flush(commands);
+  CHECK_EQ(commands.GetNumCommands(), 1);
+  olc::Sprite target{6, 6};
+  commands.Replay(target);
+  CHECK(target.GetPixel(2, 2) == olc::GREEN);
+  CHECK(target.GetPixel(1, 1) == olc::WHITE);
+
+  // Damage is tracked per primitive, the same as for single submissions.
+  std::vector<RowRange> damaged_rows;
+  queue.SubmitPrimitives(RenderLayer::kEffects, 0, primitives.data(),
+                         static_cast<int>(primitives.size()));
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+  for (const auto& primitive : primitives) {
+    queue.SubmitPrimitive(RenderLayer::kEffects, 0, primitive.x, primitive.y, primitive.color,
+                          primitive.shape);
+  }
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  CHECK(damaged_rows.empty());
+  auto moved = primitives;
+  moved[1].y = 4;
+  queue.SubmitPrimitives(RenderLayer::kEffects, 0, moved.data(), static_cast<int>(moved.size()));
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  REQUIRE_EQ(damaged_rows.size(), 1);
+  CHECK_EQ(damaged_rows[0].begin, 1);
+  CHECK_EQ(damaged_rows[0].end, 6);
+}
+
+TEST_CASE("Lines and rectangles match the engine") {
+  std::mt19937 rng{13};
+  std::uniform_int_distribution<int> coordinate{0, 39};
+  olc::PixelGameEngine engine;
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  olc::Sprite expected{40, 40};
+  engine.SetDrawTarget(&expected);
+  DrawCommandList commands;
+  for (int i = 0; i < 100; ++i) {
+    const int x0 = coordinate(rng);
+    const int y0 = coordinate(rng);
+    // Some horizontal and vertical ones.
+    const int x1 = i % 5 == 0 ? x0 : coordinate(rng);
+    const int y1 = i % 5 == 1 ? y0 : coordinate(rng);
+    const auto color = olc::Pixel(i, 255 - i, 3 * i);
+    engine.DrawLine(x0, y0, x1, y1, color);
+    commands.DrawLine(x0, y0, x1, y1, color);
+    if (i % 10 == 0) {
+      engine.FillRect(x0 - 5, y0 - 5, 12, 7, olc::WHITE);
+      commands.FillRect(x0 - 5, y0 - 5, 12, 7, olc::WHITE);
+    }
+  }
+
+  olc::Sprite actual{40, 40};
+  commands.Replay(actual);
+  CHECK(std::equal(expected.pColData.begin(), expected.pColData.end(), actual.pColData.begin()));
+}
+
+TEST_CASE("Damage covers the rows of the draws that changed") {
+  auto sprite = SolidSprite(4, 6, olc::RED);
+  const SpriteSpans spans{sprite};
+  std::vector<RowRange> damaged_rows;
+  DrawCommandList commands;
+  RenderQueue queue;
+  const auto submit_frame = [&](const int sprite_y, const int point_y) {
+    queue.SubmitRect(RenderLayer::kBackground, 0, 0, 0, 40, 40, olc::BLUE);
+    queue.SubmitSprite(RenderLayer::kEntities, 0, sprite.GetData(), spans, 3, sprite_y,
+                       olc::Sprite::Flip::NONE);
+    queue.SubmitPoint(RenderLayer::kEffects, 0, 5, point_y, olc::WHITE);
+  };
+  const auto rows_equal = [&damaged_rows](const std::vector<std::pair<int, int>>& expected) {
+    std::vector<std::pair<int, int>> actual;
+    for (const auto& rows : damaged_rows) {
+      actual.emplace_back(rows.begin, rows.end);
+    }
+    return actual == expected;
+  };
+
+  // Nothing to compare the first frame to.
+  submit_frame(10, 30);
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+
+  submit_frame(10, 30);
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  CHECK(damaged_rows.empty());
+
+  // The old and the new rows of the sprite, merged as they overlap, and the rows of the point.
+  submit_frame(12, 31);
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  CHECK(rows_equal({{10, 18}, {30, 32}}));
+
+  // The sprite disappears.
+  queue.SubmitRect(RenderLayer::kBackground, 0, 0, 0, 40, 40, olc::BLUE);
+  queue.SubmitPoint(RenderLayer::kEffects, 0, 5, 31, olc::WHITE);
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  CHECK(rows_equal({{12, 18}}));
+
+  // Callbacks can draw anything, as can whatever was flushed without tracking.
+  submit_frame(12, 31);
+  queue.SubmitCallback(RenderLayer::kDebug, 0, [] {});
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+  submit_frame(12, 31);
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+  submit_frame(12, 31);
+  queue.Flush(commands);
+  submit_frame(12, 31);
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+}
+
+TEST_CASE("Damage covers the rows of the draws that changed order") {
+  auto red = SolidSprite(4, 4, olc::RED);
+  auto green = SolidSprite(4, 4, olc::GREEN);
+  auto blue = SolidSprite(4, 4, olc::BLUE);
+  const SpriteSpans red_spans{red};
+  const SpriteSpans green_spans{green};
+  const SpriteSpans blue_spans{blue};
+  std::vector<RowRange> damaged_rows;
+  DrawCommandList commands;
+  RenderQueue queue;
+  const auto submit_frame = [&](const olc::Sprite& first, const SpriteSpans& first_spans) {
+    queue.SubmitSprite(RenderLayer::kEntities, 0, first.GetData(), first_spans, 0, 0,
+                       olc::Sprite::Flip::NONE);
+    queue.SubmitSprite(RenderLayer::kEntities, 0, green.GetData(), green_spans, 10, 10,
+                       olc::Sprite::Flip::NONE);
+    queue.SubmitSprite(RenderLayer::kEntities, 0, red.GetData(), red_spans, 12, 12,
+                       olc::Sprite::Flip::NONE);
+  };
+
+  // The two red sprites are batched, so the green one is drawn over the second.
+  submit_frame(red, red_spans);
+  CHECK_FALSE(queue.FlushDamage(commands, damaged_rows));
+
+  // Only the first sprite changes, but now the second red sprite is drawn over the green one.
+  // Their common rows must be redrawn as well.
+  submit_frame(blue, blue_spans);
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  REQUIRE_EQ(damaged_rows.size(), 2);
+  CHECK_EQ(damaged_rows[0].begin, 0);
+  CHECK_EQ(damaged_rows[0].end, 4);
+  CHECK(damaged_rows[1].begin <= 12);
+  CHECK(damaged_rows[1].end >= 14);
+
+  submit_frame(blue, blue_spans);
+  CHECK(queue.FlushDamage(commands, damaged_rows));
+  CHECK(damaged_rows.empty());
+}
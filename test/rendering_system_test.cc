@@ -0,0 +1,184 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "animation/sprite_manager.h"
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "global_defs.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kTileSize = 16;
+
+Level MakeEmptyLevel() {
+  Level level{};
+  level.level_tileset = std::make_shared<TileSet>("test", 0, 4, 1, kTileSize);
+  level.tile_grid = Grid<Tile>(100, 50);
+  return level;
+}
+
+std::vector<EntityId> GetIds(const RenderSnapshot& snapshot) {
+  std::vector<EntityId> ids;
+  for (const auto& entity : snapshot.entities) {
+    ids.push_back(entity.id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST_CASE("Snapshots only hold entities that can be on screen") {
+  auto registry = std::make_shared<Registry>();
+  auto sprite_manager = std::make_shared<SpriteManager>(registry);
+  sprite_manager->AddSprite("box", 0, 0, std::make_unique<olc::Sprite>(10, 10));
+  olc::PixelGameEngine engine;
+  RenderingSystem rendering_system{&engine,
+                                   MakeEmptyLevel(),
+                                   std::make_shared<ParameterServer>(),
+                                   sprite_manager,
+                                   registry,
+                                   std::make_shared<JobSystem>(0)};
+
+  // The screen is 40 x 22.5 tiles, the boxes are 10 pixels to the right of and above their
+  // positions.
+  const auto add_box = [&](const double x, const double y) {
+    return registry->AddComponents(Position{x, y}, SpriteComponent{"box"});
+  };
+  const auto on_screen = add_box(5, 5);
+  add_box(-1, 5);  // Left of the screen.
+  const auto partially_on_screen = add_box(39.9, 5);
+  const auto right_of_screen = add_box(80, 5);
+  add_box(5, 23);  // Above the screen.
+  const auto with_primitive = registry->AddComponents(Position{20, 5}, PrimitiveComponent{});
+  registry->AddComponents(Position{41, 5}, PrimitiveComponent{});
+
+  rendering_system.SetCameraPosition({0, 0});
+  CHECK(GetIds(rendering_system.CaptureSnapshot()) ==
+        std::vector<EntityId>{on_screen, partially_on_screen, with_primitive});
+
+  rendering_system.SetCameraPosition({50, 0});
+  CHECK(GetIds(rendering_system.CaptureSnapshot()) == std::vector<EntityId>{right_of_screen});
+}
+
+TEST_CASE("Overlapping entities are stacked in creation order") {
+  auto registry = std::make_shared<Registry>();
+  auto sprite_manager = std::make_shared<SpriteManager>(registry);
+  for (const auto& [key, color] : {std::pair{"red", olc::RED}, std::pair{"green", olc::GREEN}}) {
+    auto sprite = std::make_unique<olc::Sprite>(8, 8);
+    std::fill(sprite->pColData.begin(), sprite->pColData.end(), color);
+    sprite_manager->AddSprite(key, 0, 0, std::move(sprite));
+  }
+  olc::PixelGameEngine engine;
+  RenderingSystem rendering_system{&engine,
+                                   MakeEmptyLevel(),
+                                   std::make_shared<ParameterServer>(),
+                                   sprite_manager,
+                                   registry,
+                                   std::make_shared<JobSystem>(0)};
+  olc::Sprite framebuffer{kScreenWidthPx, kScreenHeightPx};
+  rendering_system.SetRenderTarget(&framebuffer);
+  rendering_system.SetCameraPosition({0, 0});
+
+  // The red image is submitted first, but the green entity is created before the red one on top
+  // of it.
+  registry->AddComponents(Position{5, 5}, SpriteComponent{"red"});
+  const auto below = registry->AddComponents(Position{10, 5}, SpriteComponent{"green"});
+  registry->AddComponents(Position{10, 5}, SpriteComponent{"red"});
+  rendering_system.RenderFrame(rendering_system.CaptureSnapshot());
+  CHECK(framebuffer.GetPixel(163, kScreenHeightPx - 5 * kTileSize - 4) == olc::RED);
+
+  registry->RemoveComponent(below);
+  registry->AddComponents(Position{10, 5}, SpriteComponent{"green"});
+  rendering_system.RenderFrame(rendering_system.CaptureSnapshot());
+  CHECK(framebuffer.GetPixel(163, kScreenHeightPx - 5 * kTileSize - 4) == olc::GREEN);
+}
+
+TEST_CASE("Damage tracked frames match full redraws") {
+  auto registry = std::make_shared<Registry>();
+  auto sprite_manager = std::make_shared<SpriteManager>(registry);
+  for (const auto& [key, color] : {std::pair{"a", olc::RED}, std::pair{"b", olc::GREEN}}) {
+    auto sprite = std::make_unique<olc::Sprite>(12, 9);
+    for (int y = 0; y < sprite->height; ++y) {
+      for (int x = 0; x < sprite->width; ++x) {
+        sprite->SetPixel(x, y, (x + y) % 4 == 0 ? olc::BLANK : color);
+      }
+    }
+    sprite_manager->AddSprite(key, 2, 3, std::move(sprite));
+  }
+  const auto make_rendering_system = [&](olc::PixelGameEngine& engine, const bool damage_tracking) {
+    auto parameter_server = std::make_shared<ParameterServer>();
+    auto rendering_system = std::make_unique<RenderingSystem>(
+        &engine, MakeEmptyLevel(), parameter_server, sprite_manager, registry,
+        std::make_shared<JobSystem>(0));
+    parameter_server->SetParameter<double>("rendering/damage.tracking", damage_tracking ? 1 : 0);
+    rendering_system->AddFoundationBackgroundLayer(10, 20, 30);
+    return rendering_system;
+  };
+  olc::PixelGameEngine full_engine;
+  olc::Sprite full{kScreenWidthPx, kScreenHeightPx};
+  full_engine.SetDrawTarget(&full);
+  auto full_redraws = make_rendering_system(full_engine, false);
+  olc::PixelGameEngine damage_engine;
+  olc::Sprite damaged{kScreenWidthPx, kScreenHeightPx};
+  damage_engine.SetDrawTarget(&damaged);
+  auto damage_tracked = make_rendering_system(damage_engine, true);
+
+  const auto moving = registry->AddComponents(Position{5, 5}, SpriteComponent{"a"});
+  const auto animated = registry->AddComponents(Position{10, 10}, SpriteComponent{"a"});
+  registry->AddComponents(Position{20, 3}, SpriteComponent{"b"});
+  // Overlapping, in rows away from the others. Once the moving sprite is gone, the first image
+  // submitted depends on the frame of the animated sprite, which must not change their stacking.
+  registry->AddComponents(Position{30, 12}, SpriteComponent{"b"});
+  registry->AddComponents(Position{30.25, 12.25}, SpriteComponent{"a"});
+  const auto pellet = registry->AddComponents(
+      Position{15, 15}, PrimitiveComponent{Rgba{255, 255, 255}, PrimitiveShape::kPlus});
+
+  for (int frame = 0; frame < 20; ++frame) {
+    if (frame < 8) {
+      registry->GetComponent<Position>(moving).x += 0.3;
+    } else if (frame == 8) {
+      registry->RemoveComponent(moving);
+    }
+    registry->GetComponent<Position>(pellet).y -= 0.7;
+    registry->GetComponent<SpriteComponent>(animated).key = frame % 3 == 0 ? "a" : "b";
+    if (frame == 12) {
+      full_redraws->SetCameraPosition({1, 0});
+      damage_tracked->SetCameraPosition({1, 0});
+    }
+    // Scribble over the full redraw's target, so it cannot get away with drawing less.
+    std::fill(full.pColData.begin(), full.pColData.end(), olc::BLACK);
+    full_redraws->RenderFrame(full_redraws->CaptureSnapshot());
+    damage_tracked->RenderFrame(damage_tracked->CaptureSnapshot());
+    CHECK(std::equal(full.pColData.begin(), full.pColData.end(), damaged.pColData.begin()));
+  }
+}
+
+TEST_CASE("Rendering into a framebuffer does not need the engine's draw target") {
+  auto registry = std::make_shared<Registry>();
+  olc::PixelGameEngine engine;
+  RenderingSystem rendering_system{&engine,
+                                   MakeEmptyLevel(),
+                                   std::make_shared<ParameterServer>(),
+                                   std::make_shared<SpriteManager>(registry),
+                                   registry,
+                                   std::make_shared<JobSystem>(0)};
+  rendering_system.AddFoundationBackgroundLayer(10, 20, 30);
+  olc::Sprite framebuffer{kScreenWidthPx, kScreenHeightPx};
+  rendering_system.SetRenderTarget(&framebuffer);
+
+  rendering_system.RenderFrame(rendering_system.CaptureSnapshot());
+  CHECK(std::all_of(framebuffer.pColData.begin(), framebuffer.pColData.end(),
+                    [](const olc::Pixel pixel) { return pixel == olc::Pixel(10, 20, 30); }));
+  CHECK(engine.GetDrawTarget() == nullptr);
+}
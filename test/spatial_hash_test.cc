@@ -0,0 +1,45 @@
+#include <doctest/doctest.h>
+
+#include <vector>
+
+#include "common_types/spatial_hash.h"
+
+using platformer::BoundingBox;
+using platformer::EntityId;
+using platformer::SpatialHash;
+
+TEST_CASE("SpatialHash stores every occupant of a cell") {
+  SpatialHash hash{10, 10};
+  hash.Update(1, BoundingBox{2.2, 3.5, 2.0, 4.5});
+  hash.Update(2, BoundingBox{3.1, 3.9, 3.1, 3.9});
+
+  CHECK_EQ(hash.QueryPoint(3.5, 3.5), (std::vector<EntityId>{1, 2}));
+  CHECK_EQ(hash.QueryPoint(2.5, 2.5), (std::vector<EntityId>{1}));
+  CHECK(hash.QueryPoint(8.5, 8.5).empty());
+  CHECK_EQ(hash.QueryAabb(BoundingBox{0, 9, 0, 9}), (std::vector<EntityId>{1, 2}));
+  CHECK_EQ(hash.GetNumEntities(), 2);
+}
+
+TEST_CASE("SpatialHash updates incrementally") {
+  SpatialHash hash{10, 10};
+  hash.Update(1, BoundingBox{1.5, 2.5, 1.5, 2.5});
+  hash.Update(1, BoundingBox{2.5, 3.5, 1.5, 2.5});
+  CHECK(hash.GetCell(1, 1).empty());
+  CHECK(hash.GetCell(1, 2).empty());
+  CHECK_EQ(hash.GetCell(2, 1), (std::vector<EntityId>{1}));
+  CHECK_EQ(hash.GetCell(3, 2), (std::vector<EntityId>{1}));
+
+  hash.Remove(1);
+  CHECK_FALSE(hash.Contains(1));
+  CHECK(hash.QueryAabb(BoundingBox{0, 9, 0, 9}).empty());
+}
+
+TEST_CASE("SpatialHash clamps boxes outside of the grid") {
+  SpatialHash hash{4, 4};
+  hash.Update(7, BoundingBox{-3, -2, 5, 6});
+  CHECK_EQ(hash.QueryPoint(-2.5, 5.5), (std::vector<EntityId>{7}));
+  CHECK_EQ(hash.GetCell(0, 3), (std::vector<EntityId>{7}));
+  hash.Clear();
+  CHECK(hash.GetCell(0, 3).empty());
+  CHECK_EQ(hash.GetNumEntities(), 0);
+}
@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include "olcPixelGameEngine.h"
+#include "rendering/sprite_spans.h"
+
+namespace {
+
+using namespace platformer;
+
+olc::Sprite MakeSprite(const int width, const int height, uint8_t (*alpha)(int x, int y)) {
+  olc::Sprite sprite{width, height};
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      sprite.SetPixel(x, y, olc::Pixel(20 * x, 30 * y, 7 * (x + y), alpha(x, y)));
+    }
+  }
+  return sprite;
+}
+
+uint8_t Opaque(int, int) { return 255; }
+uint8_t Binary(const int x, const int y) { return x > y ? 255 : 0; }
+uint8_t Mixed(const int x, const int y) { return (x + 2 * y) % 3 == 0 ? 0 : (x < 4 ? 255 : 90); }
+
+}  // namespace
+
+TEST_CASE("Sprites are classified by their alpha") {
+  CHECK(SpriteSpans{MakeSprite(5, 4, Opaque)}.GetOpacity() == SpriteOpacity::kOpaque);
+  CHECK(SpriteSpans{MakeSprite(5, 4, Binary)}.GetOpacity() == SpriteOpacity::kBinaryAlpha);
+  CHECK(SpriteSpans{MakeSprite(5, 4, Mixed)}.GetOpacity() == SpriteOpacity::kTrueAlpha);
+  CHECK(SpriteSpans{MakeSprite(5, 4, [](int, int) -> uint8_t { return 0; })}.IsEmpty());
+}
+
+TEST_CASE("Sprite spans cover the visible pixels") {
+  const SpriteSpans opaque{MakeSprite(5, 4, Opaque)};
+  for (int y = 0; y < 4; ++y) {
+    REQUIRE_EQ(opaque.RowEnd(y) - opaque.RowBegin(y), 1);
+    CHECK_EQ(opaque.RowBegin(y)->begin, 0);
+    CHECK_EQ(opaque.RowBegin(y)->end, 5);
+    CHECK(opaque.RowBegin(y)->opaque);
+  }
+
+  // Row 1 of Mixed: x = 0 opaque, x = 1 transparent, 2..3 opaque, 4 transparent, 5 translucent.
+  const SpriteSpans mixed{MakeSprite(6, 3, Mixed)};
+  REQUIRE_EQ(mixed.RowEnd(1) - mixed.RowBegin(1), 3);
+  const PixelSpan* span = mixed.RowBegin(1);
+  CHECK_EQ(span[0].begin, 0);
+  CHECK_EQ(span[0].end, 1);
+  CHECK_EQ(span[1].begin, 2);
+  CHECK_EQ(span[1].end, 4);
+  CHECK(span[1].opaque);
+  CHECK_EQ(span[2].begin, 5);
+  CHECK_EQ(span[2].end, 6);
+  CHECK_FALSE(span[2].opaque);
+}
+
+TEST_CASE("Drawing spans matches DrawSprite") {
+  olc::PixelGameEngine engine;
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+  const std::vector<std::pair<int, int>> positions{{3, 2}, {-4, -3}, {28, 17}, {-20, 0}};
+  for (auto* alpha : {Opaque, Binary, Mixed}) {
+    auto sprite = MakeSprite(9, 7, alpha);
+    const SpriteSpans spans{sprite};
+    for (const auto flip : {olc::Sprite::Flip::NONE, olc::Sprite::Flip::HORIZ,
+                            olc::Sprite::Flip::VERT}) {
+      for (const auto& [x, y] : positions) {
+        olc::Sprite expected{32, 20};
+        olc::Sprite actual{32, 20};
+        for (auto* target : {&expected, &actual}) {
+          for (int i = 0; i < 32 * 20; ++i) {
+            target->GetData()[i] = olc::Pixel(i % 256, 100, 200);
+          }
+        }
+        engine.SetDrawTarget(&expected);
+        engine.DrawSprite(x, y, &sprite, 1, flip);
+        DrawSpans(sprite, spans, x, y, flip, actual);
+
+        int num_mismatches = 0;
+        for (int i = 0; i < 32 * 20; ++i) {
+          num_mismatches += expected.GetData()[i] != actual.GetData()[i];
+        }
+        CHECK_EQ(num_mismatches, 0);
+      }
+    }
+  }
+}
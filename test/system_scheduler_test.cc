@@ -0,0 +1,92 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common_types/components.h"
+#include "systems/system_scheduler.h"
+#include "utils/job_system.h"
+
+using platformer::Acceleration;
+using platformer::FacingDirection;
+using platformer::StateComponent;
+using platformer::SystemAccess;
+using platformer::Velocity;
+
+TEST_CASE("SystemAccess conflicts") {
+  const auto read_velocity = SystemAccess{}.Reads<Velocity>();
+  const auto write_velocity = SystemAccess{}.Writes<Velocity>();
+  const auto write_facing = SystemAccess{}.Reads<Acceleration>().Writes<FacingDirection>();
+  const auto audio = SystemAccess{}.ReadsResource("events").WritesResource("audio");
+  const auto events = SystemAccess{}.WritesResource("events");
+
+  CHECK_FALSE(read_velocity.ConflictsWith(read_velocity));
+  CHECK(read_velocity.ConflictsWith(write_velocity));
+  CHECK(write_velocity.ConflictsWith(read_velocity));
+  CHECK(write_velocity.ConflictsWith(write_velocity));
+  CHECK_FALSE(write_facing.ConflictsWith(write_velocity));
+  CHECK_FALSE(audio.ConflictsWith(write_facing));
+  CHECK(audio.ConflictsWith(events));
+  CHECK(SystemAccess{}.Structural().ConflictsWith(read_velocity));
+  CHECK_FALSE(SystemAccess{}.Structural().ConflictsWith(audio));
+}
+
+TEST_CASE("SystemScheduler keeps the serial order of conflicting systems") {
+  auto job_system = std::make_shared<platformer::JobSystem>(3);
+  platformer::SystemScheduler scheduler{job_system};
+
+  std::mutex mutex;
+  std::vector<int> order;
+  auto record = [&](int idx) {
+    return [&, idx] {
+      std::lock_guard<std::mutex> lock{mutex};
+      order.push_back(idx);
+    };
+  };
+  scheduler.AddSystem("events", SystemAccess{}.WritesResource("events"), record(0));
+  scheduler.AddSystem("sound", SystemAccess{}.ReadsResource("events"), record(1));
+  scheduler.AddSystem("state", SystemAccess{}.Writes<StateComponent>().ReadsResource("events"),
+                      record(2));
+  scheduler.AddSystem("facing", SystemAccess{}.Reads<StateComponent>().Writes<FacingDirection>(),
+                      record(3));
+  scheduler.AddSystem("spawn", SystemAccess{}.Structural(), record(4));
+
+  CHECK(scheduler.GetDependencies(0).empty());
+  CHECK_EQ(scheduler.GetDependencies(1), std::vector<int>{0});
+  CHECK_EQ(scheduler.GetDependencies(2), std::vector<int>{0});
+  CHECK_EQ(scheduler.GetDependencies(3), std::vector<int>{2});
+  CHECK_EQ(scheduler.GetDependencies(4), (std::vector<int>{2, 3}));
+
+  for (int run = 0; run < 50; ++run) {
+    order.clear();
+    scheduler.Run();
+    REQUIRE_EQ(order.size(), 5);
+    auto position = [&](int idx) { return std::find(order.begin(), order.end(), idx); };
+    CHECK(position(0) < position(1));
+    CHECK(position(0) < position(2));
+    CHECK(position(2) < position(3));
+    CHECK(position(3) < position(4));
+  }
+}
+
+TEST_CASE("SystemScheduler matches the serial result") {
+  auto job_system = std::make_shared<platformer::JobSystem>(2);
+  platformer::SystemScheduler scheduler{job_system};
+
+  Velocity velocity{};
+  Acceleration acceleration{};
+  scheduler.AddSystem("gravity", SystemAccess{}.Writes<Acceleration>(),
+                      [&] { acceleration.y = -10; });
+  scheduler.AddSystem("integrate", SystemAccess{}.Reads<Acceleration>().Writes<Velocity>(),
+                      [&] { velocity.y += acceleration.y; });
+  scheduler.AddSystem("reset", SystemAccess{}.Writes<Acceleration>(),
+                      [&] { acceleration.y = 0; });
+
+  for (int run = 0; run < 20; ++run) {
+    scheduler.Run();
+  }
+  CHECK_EQ(velocity.y, doctest::Approx(-200));
+  CHECK_EQ(acceleration.y, doctest::Approx(0));
+}
@@ -0,0 +1,144 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "common_types/game_configuration.h"
+#include "olcPixelGameEngine.h"
+#include "rendering/draw_command_list.h"
+#include "rendering/render_queue.h"
+#include "rendering/tile_chunk_cache.h"
+
+namespace {
+
+using namespace platformer;
+
+constexpr int kTileSize = 8;
+
+// Tile 1 is opaque, tile 2 translucent with a transparent hole, tile 3 a mix of all three.
+Level MakeTestLevel() {
+  Level level{};
+  level.level_tileset = std::make_shared<TileSet>("test", 0, 4, 1, kTileSize);
+  for (int tile_id = 1; tile_id < 4; ++tile_id) {
+    auto sprite = std::make_unique<olc::Sprite>(kTileSize, kTileSize);
+    for (int y = 0; y < kTileSize; ++y) {
+      for (int x = 0; x < kTileSize; ++x) {
+        uint8_t alpha = 255;
+        if (tile_id == 2) {
+          alpha = x > 2 && x < 5 ? 0 : 128;
+        } else if (tile_id == 3) {
+          alpha = (x + y) % 3 == 0 ? 0 : (x + y) % 3 == 1 ? 200 : 255;
+        }
+        sprite->SetPixel(x, y, olc::Pixel(40 * tile_id, 10 * x, 20 * y, alpha));
+      }
+    }
+    level.level_tileset->SetTile(tile_id, 0, std::move(sprite));
+  }
+
+  level.tile_grid = Grid<Tile>(37, 23);
+  for (int y = 0; y < level.tile_grid.GetHeight(); ++y) {
+    for (int x = 0; x < level.tile_grid.GetWidth(); ++x) {
+      level.tile_grid.SetTile(x, y, Tile{0, (x * 5 + y * 3) % 4});
+    }
+  }
+  return level;
+}
+
+void FillBackground(olc::Sprite& target) {
+  for (int y = 0; y < target.height; ++y) {
+    for (int x = 0; x < target.width; ++x) {
+      target.SetPixel(x, y, olc::Pixel(x * 3, y * 5, 90));
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Tile chunks draw the same as drawing every tile") {
+  const auto level = MakeTestLevel();
+  // Small chunks and a small cache, so chunks get evicted and rebuilt. Draw does not need the whole
+  // view to be cached, so the cache is sized for a single pixel screen.
+  TileChunkCache cache{level, 4, 3, 1, 1};
+  olc::PixelGameEngine engine;
+  engine.SetPixelMode(olc::Pixel::ALPHA);
+
+  const int max_camera_x = 37 * kTileSize - 64;
+  const int max_camera_y = 23 * kTileSize - 40;
+  const std::vector<std::pair<int, int>> cameras{
+      {0, 0}, {13, 7}, {31, 32}, {max_camera_x, max_camera_y}, {13, 7}, {max_camera_x, 0}};
+  for (const auto& [camera_x, camera_y] : cameras) {
+    olc::Sprite expected{64, 40};
+    FillBackground(expected);
+    engine.SetDrawTarget(&expected);
+    for (int y = 0; y < level.tile_grid.GetHeight(); ++y) {
+      for (int x = 0; x < level.tile_grid.GetWidth(); ++x) {
+        const int tile_id = level.tile_grid.GetTile(x, y).tile_id;
+        if (tile_id != 0) {
+          engine.DrawSprite(x * kTileSize - camera_x,
+                            expected.height - (y + 1) * kTileSize + camera_y,
+                            level.level_tileset->GetTile(tile_id));
+        }
+      }
+    }
+
+    olc::Sprite actual{64, 40};
+    FillBackground(actual);
+    cache.Draw(camera_x, camera_y, actual);
+
+    int num_mismatches = 0;
+    for (int y = 0; y < actual.height; ++y) {
+      for (int x = 0; x < actual.width; ++x) {
+        const auto lhs = actual.GetPixel(x, y);
+        const auto rhs = expected.GetPixel(x, y);
+        num_mismatches += lhs.r != rhs.r || lhs.g != rhs.g || lhs.b != rhs.b;
+      }
+    }
+    CHECK_EQ(num_mismatches, 0);
+    CHECK(cache.GetNumCachedChunks() <= 3);
+  }
+  CHECK(cache.GetNumChunksBuilt() > cache.GetNumCachedChunks());
+}
+
+TEST_CASE("Tile chunks are only built once while cached") {
+  const auto level = MakeTestLevel();
+  TileChunkCache cache{level, 16, 8, 64, 40};
+  olc::Sprite target{64, 40};
+  cache.Draw(0, 0, target);
+  // The view covers one chunk.
+  CHECK_EQ(cache.GetNumChunksBuilt(), 1);
+  cache.Draw(120, 0, target);
+  CHECK_EQ(cache.GetNumChunksBuilt(), 2);
+  cache.Draw(5, 3, target);
+  CHECK_EQ(cache.GetNumChunksBuilt(), 2);
+  cache.Clear();
+  CHECK_EQ(cache.GetNumCachedChunks(), 0);
+  cache.Draw(5, 3, target);
+  CHECK_EQ(cache.GetNumChunksBuilt(), 3);
+}
+
+TEST_CASE("Tile chunk caches hold a full screen of submitted chunks") {
+  const auto level = MakeTestLevel();
+  // A 64x40 screen shows up to 3x3 chunks of 32x32 pixels.
+  TileChunkCache cache{level, 4, 1, 64, 40};
+  CHECK_EQ(cache.GetMaxNumCachedChunks(), 9);
+
+  olc::Sprite expected{64, 40};
+  FillBackground(expected);
+  cache.Draw(13, 7, expected);
+
+  olc::Sprite actual{64, 40};
+  FillBackground(actual);
+  RenderQueue queue;
+  cache.Submit(13, 7, actual.width, actual.height, RenderLayer::kTiles, queue);
+  DrawCommandList commands;
+  queue.Flush(commands);
+  commands.Replay(actual);
+  CHECK(std::equal(actual.pColData.begin(), actual.pColData.end(), expected.pColData.begin()));
+
+  // A larger target is rejected before any chunk is fetched, so none are evicted.
+  const int num_chunks_built = cache.GetNumChunksBuilt();
+  CHECK_THROWS_AS(cache.Submit(13, 7, 128, 80, RenderLayer::kTiles, queue), std::runtime_error);
+  CHECK_EQ(cache.GetNumChunksBuilt(), num_chunks_built);
+  CHECK_EQ(queue.GetNumSubmitted(), 0);
+}
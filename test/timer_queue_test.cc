@@ -0,0 +1,67 @@
+#include <doctest/doctest.h>
+
+#include <vector>
+
+#include "registry.h"
+#include "utils/timer_queue.h"
+
+using platformer::FromSecs;
+using platformer::TimePoint;
+using platformer::TimerQueue;
+
+TEST_CASE("TimerQueue runs due callbacks in order") {
+  const TimePoint start{};
+  TimerQueue timers;
+  std::vector<int> order;
+  timers.Schedule(start + FromSecs(2.), [&] { order.push_back(2); });
+  timers.Schedule(start + FromSecs(1.), [&] { order.push_back(1); });
+  timers.Schedule(start + FromSecs(1.), [&] { order.push_back(11); });
+  const auto cancelled = timers.Schedule(start + FromSecs(0.5), [&] { order.push_back(-1); });
+  timers.Schedule(start + FromSecs(3.), [&] { order.push_back(3); });
+
+  CHECK(timers.Cancel(cancelled));
+  CHECK_FALSE(timers.Cancel(cancelled));
+  CHECK_EQ(timers.GetNumPending(), 4);
+  CHECK(timers.GetNextDue() == start + FromSecs(1.));
+
+  CHECK_EQ(timers.RunDue(start + FromSecs(0.9)), 0);
+  CHECK_EQ(timers.RunDue(start + FromSecs(2.)), 3);
+  CHECK_EQ(order, (std::vector<int>{1, 11, 2}));
+  CHECK_EQ(timers.GetNumPending(), 1);
+
+  timers.Clear();
+  CHECK_FALSE(timers.GetNextDue().has_value());
+}
+
+TEST_CASE("TimerQueue callbacks can schedule more timers") {
+  const TimePoint start{};
+  TimerQueue timers;
+  int num_ticks = 0;
+  std::function<void()> tick = [&] {
+    ++num_ticks;
+    timers.Schedule(start + FromSecs(num_ticks), tick);
+  };
+  timers.Schedule(start, tick);
+  // Already due ones run straight away.
+  CHECK_EQ(timers.RunDue(start + FromSecs(2.5)), 3);
+  CHECK_EQ(num_ticks, 3);
+  CHECK(timers.GetNextDue() == start + FromSecs(3.));
+}
+
+TEST_CASE("Registry notifies about added components") {
+  platformer::Registry registry;
+  std::vector<platformer::EntityId> added;
+  TimePoint added_time{};
+  registry.OnAdded<platformer::TimeToDespawn>(
+      [&](const platformer::EntityId id, const platformer::TimeToDespawn& time_to_despawn) {
+        added.push_back(id);
+        added_time = time_to_despawn.time_to_despawn;
+      });
+
+  registry.AddComponents(platformer::Position{});
+  platformer::TimeToDespawn time_to_despawn{};
+  time_to_despawn.time_to_despawn = TimePoint{} + FromSecs(4.);
+  const auto id = registry.AddComponents(platformer::Position{}, time_to_despawn);
+  CHECK_EQ(added, (std::vector<platformer::EntityId>{id}));
+  CHECK(added_time == time_to_despawn.time_to_despawn);
+}
@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+#include "animation/sprite_manager.h"
+#include "common_types/components.h"
+#include "common_types/game_configuration.h"
+#include "global_defs.h"
+#include "olcPixelGameEngine.h"
+#include "registry.h"
+#include "systems/physics_system.h"
+#include "systems/rendering_system.h"
+#include "utils/job_system.h"
+#include "utils/parameter_server.h"
+#include "utils/worker_thread.h"
+
+namespace {
+
+using namespace platformer;
+
+Level MakeEmptyLevel() {
+  Level level{};
+  level.level_tileset = std::make_shared<TileSet>("test", 0, 4, 1, 16);
+  level.tile_grid = Grid<Tile>(100, 50);
+  level.property_grid = Grid<int>(100, 50);
+  return level;
+}
+
+}  // namespace
+
+TEST_CASE("WorkerThread runs submitted tasks and rethrows their exceptions") {
+  WorkerThread worker;
+  std::atomic<int> num_runs{0};
+  worker.Submit([&] { num_runs++; });
+  worker.Wait();
+  CHECK_EQ(num_runs.load(), 1);
+
+  // Waiting without a task in flight returns straight away.
+  worker.Wait();
+
+  worker.Submit([] { throw std::runtime_error("task failed"); });
+  CHECK_THROWS_AS(worker.Wait(), std::runtime_error);
+  // The exception is only rethrown once, the worker keeps going.
+  worker.Wait();
+  worker.Submit([&] { num_runs++; });
+  worker.Wait();
+  CHECK_EQ(num_runs.load(), 2);
+}
+
+TEST_CASE("WorkerThread rejects a second task while one is in flight") {
+  WorkerThread worker;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  worker.Submit([released] { released.wait(); });
+  CHECK(worker.Busy());
+  CHECK_THROWS_AS(worker.Submit([] {}), std::runtime_error);
+
+  release.set_value();
+  worker.Wait();
+  CHECK_FALSE(worker.Busy());
+  worker.Submit([] {});
+  worker.Wait();
+}
+
+TEST_CASE("Snapshots do not change while the simulation runs") {
+  auto registry = std::make_shared<Registry>();
+  auto sprite_manager = std::make_shared<SpriteManager>(registry);
+  auto sprite = std::make_unique<olc::Sprite>(10, 10);
+  std::fill(sprite->pColData.begin(), sprite->pColData.end(), olc::RED);
+  sprite_manager->AddSprite("box", 0, 0, std::move(sprite));
+  const auto level = MakeEmptyLevel();
+  auto parameter_server = std::make_shared<ParameterServer>();
+  auto job_system = std::make_shared<JobSystem>(0);
+  olc::PixelGameEngine engine;
+  RenderingSystem rendering_system{&engine,        level,    parameter_server,
+                                   sprite_manager, registry, job_system};
+  rendering_system.AddFoundationBackgroundLayer(10, 20, 30);
+  rendering_system.SetCameraPosition({0, 0});
+  PhysicsSystem physics{level, parameter_server, job_system, registry};
+  for (int i = 0; i < 10; ++i) {
+    registry->AddComponents(Position{5. + 3 * i, 5. + i}, Velocity{20., 10.},
+                            CollisionBox{0, 0, 10, 10}, Collision{}, SpriteComponent{"box"});
+  }
+
+  const auto render = [&](const RenderSnapshot& snapshot) {
+    olc::Sprite framebuffer{kScreenWidthPx, kScreenHeightPx};
+    rendering_system.SetRenderTarget(&framebuffer);
+    rendering_system.RenderFrame(snapshot);
+    return framebuffer;
+  };
+  const auto snapshot = rendering_system.CaptureSnapshot();
+  const auto before = render(snapshot);
+
+  // As in the pipelined game loop: the snapshot is rendered while the next step is simulated.
+  WorkerThread worker;
+  worker.Submit([&] { physics.PhysicsStep(0.1); });
+  const auto during = render(snapshot);
+  worker.Wait();
+  const auto after = render(snapshot);
+
+  CHECK(std::equal(before.pColData.begin(), before.pColData.end(), during.pColData.begin()));
+  CHECK(std::equal(before.pColData.begin(), before.pColData.end(), after.pColData.begin()));
+  // The entities did move.
+  const auto moved = render(rendering_system.CaptureSnapshot());
+  CHECK_FALSE(std::equal(before.pColData.begin(), before.pColData.end(), moved.pColData.begin()));
+}